@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../src/utils/cpu.h"
+#include "../src/utils/stats.h"
+#include "../src/utils/timestamp.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+inline void pin_current_thread(int cpu) {
+    if (cpu >= 0) {
+        market::ThreadPlacement placement;
+        placement.cpu = cpu;
+        market::apply_thread_placement(placement);
+    }
+}
+
+inline uint64_t timer_overhead_ns() {
+    constexpr int kSamples = 100'000;
+    const uint64_t start = market::now_ns();
+    uint64_t sink = 0;
+    for (int i = 0; i < kSamples; ++i) {
+        sink += market::now_ns();
+    }
+    const uint64_t elapsed = market::now_ns() - start;
+    return sink == 0 ? 0 : elapsed / kSamples;
+}
+
+struct Result {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> params;
+    uint64_t ops{0};
+    uint64_t elapsed_ns{0};
+    market::LatencySnapshot latency;
+};
+
+inline void print_json(const Result& result) {
+    const double ops = static_cast<double>(result.ops);
+    const double elapsed = static_cast<double>(result.elapsed_ns);
+
+    std::cout << "{\"bench\":\"" << result.name << "\"";
+    for (const auto& [key, value] : result.params) {
+        std::cout << ",\"" << key << "\":\"" << value << "\"";
+    }
+    std::cout << ",\"ops\":" << result.ops
+              << ",\"ns_per_op\":" << (result.ops == 0 ? 0.0 : elapsed / ops)
+              << ",\"msgs_per_sec\":" << (result.elapsed_ns == 0 ? 0.0 : ops * 1e9 / elapsed)
+              << ",\"p50_ns\":" << result.latency.p50_ns
+              << ",\"p99_ns\":" << result.latency.p99_ns
+              << ",\"p999_ns\":" << result.latency.p999_ns
+              << ",\"max_ns\":" << result.latency.max_ns
+              << "}\n";
+}
+
+}
@@ -0,0 +1,387 @@
+
+#include "bench_util.h"
+#include "../src/market_data.h"
+#include "../src/message_parser.h"
+#include "../src/order_book.h"
+#include "../src/ring_buffer.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct BenchConfig {
+    uint64_t iterations{1'000'000};
+    uint64_t round_trips{100'000};
+    uint32_t depth{100};
+    uint32_t orders{10'000};
+    int cpu_a{-1};
+    int cpu_b{-1};
+    std::string only;
+};
+
+BenchConfig parse_args(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            cfg.iterations = static_cast<uint64_t>(std::stoull(argv[++i]));
+        } else if (arg == "--round-trips" && i + 1 < argc) {
+            cfg.round_trips = static_cast<uint64_t>(std::stoull(argv[++i]));
+        } else if (arg == "--depth" && i + 1 < argc) {
+            cfg.depth = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--orders" && i + 1 < argc) {
+            cfg.orders = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--cpu-a" && i + 1 < argc) {
+            cfg.cpu_a = std::stoi(argv[++i]);
+        } else if (arg == "--cpu-b" && i + 1 < argc) {
+            cfg.cpu_b = std::stoi(argv[++i]);
+        } else if (arg == "--only" && i + 1 < argc) {
+            cfg.only = argv[++i];
+        }
+    }
+    return cfg;
+}
+
+bool enabled(const BenchConfig& cfg, const char* suite) {
+    return cfg.only.empty() || cfg.only == suite;
+}
+
+void bench_spsc_round_trip(const BenchConfig& cfg) {
+    using Ring = market::SPSCRingBuffer<uint64_t, 1024>;
+    auto ping = std::make_unique<Ring>();
+    auto pong = std::make_unique<Ring>();
+    std::atomic<bool> ready{false};
+
+    std::thread echo([&]() {
+        bench::pin_current_thread(cfg.cpu_b);
+        ready.store(true, std::memory_order_release);
+
+        uint64_t value = 0;
+        for (uint64_t trip = 0; trip < cfg.round_trips; ++trip) {
+            while (!ping->try_pop(value)) {
+            }
+            while (!pong->try_push(value)) {
+            }
+        }
+    });
+
+    bench::pin_current_thread(cfg.cpu_a);
+    while (!ready.load(std::memory_order_acquire)) {
+    }
+
+    market::LatencyStats latency;
+    const uint64_t begin = market::now_ns();
+    for (uint64_t trip = 0; trip < cfg.round_trips; ++trip) {
+        const uint64_t sent = market::now_ns();
+        while (!ping->try_push(sent)) {
+        }
+
+        uint64_t echoed = 0;
+        while (!pong->try_pop(echoed)) {
+        }
+        latency.record(market::now_ns() - echoed);
+    }
+    const uint64_t elapsed = market::now_ns() - begin;
+    echo.join();
+
+    bench::Result result;
+    result.name = "spsc_round_trip";
+    result.params = {{"cpu_a", std::to_string(cfg.cpu_a)}, {"cpu_b", std::to_string(cfg.cpu_b)}};
+    result.ops = cfg.round_trips;
+    result.elapsed_ns = elapsed;
+    result.latency = latency.snapshot();
+    bench::print_json(result);
+}
+
+template <typename T>
+market::RawMessage make_message(uint16_t type) {
+    market::RawMessage raw{};
+    T body{};
+    body.header.msg_type = type;
+    body.header.msg_len = static_cast<uint16_t>(sizeof(T));
+    std::memcpy(raw.payload.data(), &body, sizeof(T));
+    raw.len = sizeof(T);
+    return raw;
+}
+
+void bench_parse(const BenchConfig& cfg, const char* name, market::RawMessage raw) {
+    auto* header = reinterpret_cast<market::MessageHeader*>(raw.payload.data());
+    market::MessageParser parser;
+    uint32_t sequence = 1;
+    uint64_t accepted = 0;
+
+    const uint64_t begin = market::now_ns();
+    for (uint64_t i = 0; i < cfg.iterations; ++i) {
+        header->sequence_num = sequence++;
+        accepted += parser.parse(raw) != nullptr;
+    }
+    const uint64_t elapsed = market::now_ns() - begin;
+
+    market::LatencyStats latency;
+    for (uint64_t i = 0; i < cfg.iterations; ++i) {
+        header->sequence_num = sequence++;
+        const uint64_t start = market::now_ns();
+        accepted += parser.parse(raw) != nullptr;
+        latency.record(market::now_ns() - start);
+    }
+
+    bench::Result result;
+    result.name = "parse";
+    result.params = {{"msg_type", name}, {"accepted", std::to_string(accepted)}};
+    result.ops = cfg.iterations;
+    result.elapsed_ns = elapsed;
+    result.latency = latency.snapshot();
+    bench::print_json(result);
+}
+
+void bench_parse_packet(const BenchConfig& cfg, uint32_t reorder_window) {
+    market::RawMessage raw{};
+    size_t per_packet = 0;
+    while (raw.len + sizeof(market::Quote) <= 1400) {
+        market::Quote quote{};
+        quote.header.msg_type = market::MSG_QUOTE;
+        quote.header.msg_len = static_cast<uint16_t>(sizeof(quote));
+        std::memcpy(raw.payload.data() + raw.len, &quote, sizeof(quote));
+        raw.len += sizeof(quote);
+        ++per_packet;
+    }
+
+    std::array<market::RawMessage, 2> pair{raw, raw};
+    auto stamp = [&](market::RawMessage& packet, uint32_t first) {
+        for (size_t idx = 0; idx < per_packet; ++idx) {
+            auto* header = reinterpret_cast<market::MessageHeader*>(packet.payload.data() + idx * sizeof(market::Quote));
+            header->sequence_num = first + static_cast<uint32_t>(idx);
+        }
+    };
+
+    market::ReorderConfig reorder;
+    reorder.window = reorder_window;
+    market::MessageParser parser(reorder);
+    uint32_t sequence = 1;
+    uint64_t delivered = 0;
+    const uint64_t pairs = cfg.iterations / (2 * per_packet) + 1;
+
+    market::LatencyStats latency;
+    const uint64_t begin = market::now_ns();
+    for (uint64_t i = 0; i < pairs; ++i) {
+        const bool swap = reorder_window != 0 && i != 0;
+        stamp(pair[swap ? 1 : 0], sequence);
+        stamp(pair[swap ? 0 : 1], sequence + static_cast<uint32_t>(per_packet));
+        sequence += static_cast<uint32_t>(2 * per_packet);
+
+        for (const market::RawMessage& packet : pair) {
+            const uint64_t start = market::now_ns();
+            delivered += parser.parse_packet(packet, [](const market::MessageHeader*) {});
+            latency.record(market::now_ns() - start);
+        }
+    }
+    const uint64_t elapsed = market::now_ns() - begin;
+
+    bench::Result result;
+    result.name = "parse_packet";
+    result.params = {{"msg_type", "quote"}, {"per_packet", std::to_string(per_packet)},
+                     {"reorder_window", std::to_string(reorder_window)},
+                     {"reordered", std::to_string(parser.reordered_messages())}};
+    result.ops = delivered;
+    result.elapsed_ns = elapsed;
+    result.latency = latency.snapshot();
+    bench::print_json(result);
+}
+
+struct BookWorkload {
+    std::vector<market::OrderAdd> adds;
+    std::vector<market::OrderCancel> cancels;
+    std::vector<market::OrderModify> modifies;
+    std::vector<market::Quote> quotes;
+};
+
+BookWorkload build_book_workload(const BenchConfig& cfg) {
+    constexpr int64_t kMid = 1'500'000;
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<uint32_t> level_dist(1, cfg.depth > 0 ? cfg.depth : 1);
+    std::uniform_int_distribution<uint32_t> size_dist(100, 500);
+    std::uniform_int_distribution<int> side_dist(0, 1);
+
+    BookWorkload workload;
+    std::vector<uint64_t> live;
+    std::unordered_map<uint64_t, uint32_t> sizes;
+    live.reserve(cfg.orders);
+
+    auto make_add = [&](uint64_t order_id) {
+        market::OrderAdd add{};
+        add.header.msg_type = market::MSG_ORDER_ADD;
+        add.header.msg_len = sizeof(add);
+        add.order_id = order_id;
+        add.symbol_id = 1000;
+        add.side = side_dist(rng) ? 'B' : 'S';
+        const int64_t offset = static_cast<int64_t>(level_dist(rng));
+        add.price = add.side == 'B' ? kMid - offset : kMid + offset;
+        add.size = size_dist(rng);
+        return add;
+    };
+
+    uint64_t next_id = 1;
+    for (uint32_t i = 0; i < cfg.orders; ++i) {
+        workload.adds.push_back(make_add(next_id));
+        sizes[next_id] = workload.adds.back().size;
+        live.push_back(next_id++);
+    }
+
+    for (uint64_t i = 0; i < cfg.iterations; ++i) {
+        workload.adds.push_back(make_add(next_id));
+        sizes[next_id] = workload.adds.back().size;
+        live.push_back(next_id++);
+
+        const size_t pick = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+        market::OrderCancel cancel{};
+        cancel.header.msg_type = market::MSG_ORDER_CANCEL;
+        cancel.header.msg_len = sizeof(cancel);
+        cancel.order_id = live[pick];
+        cancel.symbol_id = 1000;
+        workload.cancels.push_back(cancel);
+        sizes.erase(live[pick]);
+        live[pick] = live.back();
+        live.pop_back();
+
+        market::Quote quote{};
+        quote.header.msg_type = market::MSG_QUOTE;
+        quote.header.msg_len = sizeof(quote);
+        quote.symbol_id = 1000;
+        quote.bid_price = kMid - static_cast<int64_t>(level_dist(rng));
+        quote.ask_price = kMid + static_cast<int64_t>(level_dist(rng));
+        quote.bid_size = size_dist(rng);
+        quote.ask_size = size_dist(rng);
+        workload.quotes.push_back(quote);
+    }
+
+    for (uint64_t i = 0; i < cfg.iterations && !live.empty(); ++i) {
+        const uint64_t order_id = live[std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng)];
+        uint32_t& size = sizes[order_id];
+        market::OrderModify modify{};
+        modify.header.msg_type = market::MSG_ORDER_MODIFY;
+        modify.header.msg_len = sizeof(modify);
+        modify.order_id = order_id;
+        modify.symbol_id = 1000;
+        modify.size = size > 1 ? --size : size;
+        workload.modifies.push_back(modify);
+    }
+    return workload;
+}
+
+template <typename Book>
+void bench_book(const BenchConfig& cfg, const char* engine, const BookWorkload& workload) {
+    market::BookConfig book_cfg;
+    book_cfg.order_capacity = static_cast<size_t>(cfg.orders) * 2 + 1024;
+
+    const auto params = [&](const char* op) {
+        return std::vector<std::pair<std::string, std::string>>{
+            {"engine", engine}, {"op", op},
+            {"depth", std::to_string(cfg.depth)}, {"orders", std::to_string(cfg.orders)}};
+    };
+
+    Book book(book_cfg);
+    for (uint32_t i = 0; i < cfg.orders; ++i) {
+        book.on_order_add(workload.adds[i]);
+    }
+
+    market::LatencyStats add_latency;
+    market::LatencyStats cancel_latency;
+    market::LatencyStats quote_latency;
+    uint64_t add_ns = 0;
+    uint64_t cancel_ns = 0;
+    uint64_t quote_ns = 0;
+
+    for (uint64_t i = 0; i < cfg.iterations; ++i) {
+        uint64_t start = market::now_ns();
+        book.on_order_add(workload.adds[cfg.orders + i]);
+        uint64_t end = market::now_ns();
+        add_ns += end - start;
+        add_latency.record(end - start);
+
+        start = market::now_ns();
+        book.on_order_cancel(workload.cancels[i]);
+        end = market::now_ns();
+        cancel_ns += end - start;
+        cancel_latency.record(end - start);
+    }
+
+    market::LatencyStats modify_latency;
+    uint64_t modify_ns = 0;
+    for (const market::OrderModify& modify : workload.modifies) {
+        const uint64_t start = market::now_ns();
+        book.on_order_modify(modify);
+        const uint64_t end = market::now_ns();
+        modify_ns += end - start;
+        modify_latency.record(end - start);
+    }
+
+    Book quote_book(book_cfg);
+    for (uint64_t i = 0; i < cfg.iterations; ++i) {
+        const uint64_t start = market::now_ns();
+        quote_book.on_quote(workload.quotes[i]);
+        const uint64_t end = market::now_ns();
+        quote_ns += end - start;
+        quote_latency.record(end - start);
+    }
+
+    const std::pair<const char*, std::pair<uint64_t, market::LatencyStats*>> ops[] = {
+        {"add", {add_ns, &add_latency}},
+        {"cancel", {cancel_ns, &cancel_latency}},
+        {"modify", {modify_ns, &modify_latency}},
+        {"quote", {quote_ns, &quote_latency}},
+    };
+    for (const auto& [op, data] : ops) {
+        bench::Result result;
+        result.name = "order_book";
+        result.params = params(op);
+        result.ops = cfg.iterations;
+        result.elapsed_ns = data.first;
+        result.latency = data.second->snapshot();
+        bench::print_json(result);
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    const BenchConfig cfg = parse_args(argc, argv);
+
+    bench::Result overhead;
+    overhead.name = "timer_overhead";
+    overhead.ops = 1;
+    overhead.elapsed_ns = bench::timer_overhead_ns();
+    bench::print_json(overhead);
+
+    if (enabled(cfg, "spsc")) {
+        bench_spsc_round_trip(cfg);
+    }
+
+    if (enabled(cfg, "parse")) {
+        bench_parse(cfg, "quote", make_message<market::Quote>(market::MSG_QUOTE));
+        bench_parse(cfg, "trade", make_message<market::Trade>(market::MSG_TRADE));
+        bench_parse(cfg, "order_add", make_message<market::OrderAdd>(market::MSG_ORDER_ADD));
+        bench_parse(cfg, "order_cancel", make_message<market::OrderCancel>(market::MSG_ORDER_CANCEL));
+        bench_parse(cfg, "order_execute", make_message<market::OrderExecute>(market::MSG_ORDER_EXECUTE));
+        bench_parse(cfg, "order_modify", make_message<market::OrderModify>(market::MSG_ORDER_MODIFY));
+        bench_parse(cfg, "order_replace", make_message<market::OrderReplace>(market::MSG_ORDER_REPLACE));
+        bench_parse_packet(cfg, 0);
+        bench_parse_packet(cfg, 4096);
+    }
+
+    if (enabled(cfg, "book")) {
+        const BookWorkload workload = build_book_workload(cfg);
+        bench_book<market::OrderBook<market::MapLevels, market::StdOrderIndex>>(cfg, "map", workload);
+        bench_book<market::OrderBook<market::TickLadder, market::FlatOrderIndex>>(cfg, "ladder_flat", workload);
+    }
+
+    return 0;
+}
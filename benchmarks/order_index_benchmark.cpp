@@ -0,0 +1,116 @@
+
+#include "../src/order_index.h"
+#include "../src/utils/timestamp.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct BenchConfig {
+    size_t live_orders{1'000'000};
+    size_t operations{10'000'000};
+    uint32_t cancel_percent{50};
+};
+
+BenchConfig parse_args(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--live" && i + 1 < argc) {
+            cfg.live_orders = static_cast<size_t>(std::stoull(argv[++i]));
+        } else if (arg == "--ops" && i + 1 < argc) {
+            cfg.operations = static_cast<size_t>(std::stoull(argv[++i]));
+        } else if (arg == "--cancel-percent" && i + 1 < argc) {
+            cfg.cancel_percent = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+    }
+    return cfg;
+}
+
+constexpr uint64_t kCancelFlag = 1ULL << 63;
+
+struct Workload {
+    std::vector<uint64_t> ops;
+    size_t peak_live{0};
+};
+
+Workload build_workload(const BenchConfig& cfg) {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<uint32_t> percent(0, 99);
+
+    std::vector<uint64_t> live(cfg.live_orders);
+    for (size_t idx = 0; idx < live.size(); ++idx) {
+        live[idx] = idx + 1;
+    }
+    uint64_t next_id = cfg.live_orders + 1;
+
+    Workload workload;
+    auto& ops = workload.ops;
+    ops.reserve(cfg.operations);
+    workload.peak_live = live.size();
+    for (size_t op = 0; op < cfg.operations; ++op) {
+        if (!live.empty() && percent(rng) < cfg.cancel_percent) {
+            const size_t pick = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+            ops.push_back(live[pick] | kCancelFlag);
+            live[pick] = live.back();
+            live.pop_back();
+        } else {
+            ops.push_back(next_id);
+            live.push_back(next_id++);
+            workload.peak_live = std::max(workload.peak_live, live.size());
+        }
+    }
+    return workload;
+}
+
+template <typename Index>
+void run(const char* name, const BenchConfig& cfg, const Workload& workload) {
+    const auto& ops = workload.ops;
+    market::BookConfig book_cfg;
+    book_cfg.order_capacity = workload.peak_live;
+
+    Index index(book_cfg);
+    for (uint64_t id = 1; id <= cfg.live_orders; ++id) {
+        index.insert(market::Order{id, 1, 1'500'000, 100, 'B'});
+    }
+
+    uint64_t failures = 0;
+    const uint64_t start = market::now_ns();
+    for (const uint64_t op : ops) {
+        if (op & kCancelFlag) {
+            const uint64_t id = op & ~kCancelFlag;
+            const market::Order* order = index.find(id);
+            if (order == nullptr || !index.erase(id)) {
+                ++failures;
+            }
+        } else if (!index.insert(market::Order{op, 1, 1'500'000, 100, 'S'})) {
+            ++failures;
+        }
+    }
+    const uint64_t elapsed = market::now_ns() - start;
+
+    std::cout << "index=" << name
+              << " live=" << cfg.live_orders
+              << " ops=" << ops.size()
+              << " final_size=" << index.size()
+              << " failures=" << failures
+              << " ns_per_op=" << static_cast<double>(elapsed) / static_cast<double>(ops.size())
+              << " ops_per_sec=" << static_cast<double>(ops.size()) * 1e9 / static_cast<double>(elapsed)
+              << "\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    const BenchConfig cfg = parse_args(argc, argv);
+    const Workload workload = build_workload(cfg);
+
+    run<market::StdOrderIndex>("unordered_map", cfg, workload);
+    run<market::FlatOrderIndex>("flat", cfg, workload);
+    return 0;
+}
@@ -0,0 +1,126 @@
+
+#include "bench_util.h"
+#include "../src/ring_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct BenchConfig {
+    uint64_t messages{20'000'000};
+    std::vector<size_t> batch_sizes{1, 4, 16, 64, 256};
+    int producer_cpu{-1};
+    int consumer_cpu{-1};
+};
+
+BenchConfig parse_args(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--messages" && i + 1 < argc) {
+            cfg.messages = static_cast<uint64_t>(std::stoull(argv[++i]));
+        } else if (arg == "--batches" && i + 1 < argc) {
+            cfg.batch_sizes.clear();
+            std::istringstream iss(argv[++i]);
+            std::string token;
+            while (std::getline(iss, token, ',')) {
+                if (!token.empty()) {
+                    cfg.batch_sizes.push_back(static_cast<size_t>(std::stoull(token)));
+                }
+            }
+        } else if (arg == "--producer-cpu" && i + 1 < argc) {
+            cfg.producer_cpu = std::stoi(argv[++i]);
+        } else if (arg == "--consumer-cpu" && i + 1 < argc) {
+            cfg.consumer_cpu = std::stoi(argv[++i]);
+        }
+    }
+    return cfg;
+}
+
+struct Item {
+    uint64_t sequence;
+    uint64_t enqueue_ns;
+};
+
+using Ring = market::SPSCRingBuffer<Item, 4096>;
+
+void run(const BenchConfig& cfg, size_t batch) {
+    auto ring = std::make_unique<Ring>();
+    std::atomic<bool> start{false};
+    market::LatencyStats latency;
+    uint64_t out_of_order = 0;
+
+    std::thread consumer([&]() {
+        bench::pin_current_thread(cfg.consumer_cpu);
+        std::vector<Item> items(batch);
+        uint64_t expected = 0;
+
+        while (!start.load(std::memory_order_acquire)) {
+        }
+
+        while (expected < cfg.messages) {
+            const size_t popped = ring->try_pop_n(items.data(), batch);
+            if (popped == 0) {
+                continue;
+            }
+
+            const uint64_t now = market::now_ns();
+            for (size_t idx = 0; idx < popped; ++idx) {
+                if (items[idx].sequence != expected) {
+                    ++out_of_order;
+                }
+                latency.record(now - items[idx].enqueue_ns);
+                ++expected;
+            }
+        }
+    });
+
+    bench::pin_current_thread(cfg.producer_cpu);
+    std::vector<Item> items(batch);
+    start.store(true, std::memory_order_release);
+
+    const uint64_t begin = market::now_ns();
+    uint64_t sent = 0;
+    while (sent < cfg.messages) {
+        const size_t wanted = static_cast<size_t>(std::min<uint64_t>(batch, cfg.messages - sent));
+        const uint64_t now = market::now_ns();
+        for (size_t idx = 0; idx < wanted; ++idx) {
+            items[idx] = Item{sent + idx, now};
+        }
+
+        size_t pushed = 0;
+        while (pushed < wanted) {
+            pushed += ring->try_push_n(items.data() + pushed, wanted - pushed);
+        }
+        sent += wanted;
+    }
+
+    consumer.join();
+    bench::Result result;
+    result.name = "spsc_batch_throughput";
+    result.params = {{"batch", std::to_string(batch)}, {"out_of_order", std::to_string(out_of_order)}};
+    result.ops = cfg.messages;
+    result.elapsed_ns = market::now_ns() - begin;
+    result.latency = latency.snapshot();
+    bench::print_json(result);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const BenchConfig cfg = parse_args(argc, argv);
+
+    for (const size_t batch : cfg.batch_sizes) {
+        if (batch > 0) {
+            run(cfg, batch);
+        }
+    }
+    return 0;
+}
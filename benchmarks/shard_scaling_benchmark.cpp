@@ -0,0 +1,161 @@
+#include "bench_util.h"
+#include "../src/book_manager.h"
+#include "../src/market_data.h"
+#include "../src/message_handler.h"
+#include "../src/message_parser.h"
+#include "../src/order_book.h"
+#include "../src/shard.h"
+#include "../src/trade_analytics.h"
+#include "../src/wait_strategy.h"
+#include "../tools/feed_generator.h"
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Book = market::OrderBook<market::TickLadder, market::FlatOrderIndex>;
+using Shard = market::ProcessorShard<Book>;
+
+struct BenchConfig {
+    uint64_t messages{4'000'000};
+    uint32_t symbols{1000};
+    std::vector<uint32_t> shard_counts{0, 1, 2, 4};
+    int dispatch_cpu{-1};
+    std::vector<int> shard_cpus;
+    market::WaitMode wait{market::WaitMode::Yield};
+};
+
+BenchConfig parse_args(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--messages" && i + 1 < argc) {
+            cfg.messages = static_cast<uint64_t>(std::stoull(argv[++i]));
+        } else if (arg == "--symbols" && i + 1 < argc) {
+            cfg.symbols = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--dispatch-cpu" && i + 1 < argc) {
+            cfg.dispatch_cpu = std::stoi(argv[++i]);
+        } else if (arg == "--wait" && i + 1 < argc) {
+            market::parse_wait_mode(argv[++i], cfg.wait);
+        } else if ((arg == "--shards" || arg == "--shard-cpus") && i + 1 < argc) {
+            std::istringstream iss(argv[++i]);
+            std::string token;
+            if (arg == "--shards") {
+                cfg.shard_counts.clear();
+            }
+            while (std::getline(iss, token, ',')) {
+                if (arg == "--shards") {
+                    cfg.shard_counts.push_back(static_cast<uint32_t>(std::stoul(token)));
+                } else {
+                    cfg.shard_cpus.push_back(std::stoi(token));
+                }
+            }
+        }
+    }
+    return cfg;
+}
+
+std::vector<char> build_feed(const BenchConfig& cfg, std::vector<uint32_t>& offsets) {
+    feed::FeedGenerator generator(cfg.symbols);
+    std::vector<char> buffer;
+    buffer.reserve(cfg.messages * sizeof(market::OrderReplace));
+    offsets.reserve(cfg.messages);
+    for (uint64_t i = 0; i < cfg.messages; ++i) {
+        const market::MessageHeader* header = generator.next();
+        offsets.push_back(static_cast<uint32_t>(buffer.size()));
+        const char* bytes = reinterpret_cast<const char*>(header);
+        buffer.insert(buffer.end(), bytes, bytes + header->msg_len);
+    }
+    return buffer;
+}
+
+void run(const BenchConfig& cfg, uint32_t shard_count, const std::vector<char>& feed,
+         const std::vector<uint32_t>& offsets) {
+
+    const uint32_t max_symbol_id = 1000 + cfg.symbols;
+    uint64_t stalls = 0;
+    uint64_t elapsed = 0;
+
+    if (shard_count == 0) {
+        market::BookManager<Book> books(cfg.symbols, max_symbol_id);
+        market::TradeAnalytics trades(cfg.symbols, max_symbol_id);
+        market::HandlerChain<market::TradeAnalytics, market::BookManager<Book>> handlers(trades, books);
+
+        const uint64_t begin = market::now_ns();
+        for (const uint32_t offset : offsets) {
+            handlers.on_message(reinterpret_cast<const market::MessageHeader*>(feed.data() + offset));
+        }
+        elapsed = market::now_ns() - begin;
+    } else {
+        market::ShardConfig config;
+        config.universe_size = cfg.symbols;
+        config.max_symbol_id = max_symbol_id;
+        config.wait = cfg.wait;
+
+        std::vector<std::unique_ptr<Shard>> shards;
+        for (uint32_t idx = 0; idx < shard_count; ++idx) {
+            config.placement.cpu = idx < cfg.shard_cpus.size() ? cfg.shard_cpus[idx] : -1;
+            shards.push_back(std::make_unique<Shard>(config));
+            shards.back()->start();
+        }
+
+        auto push = [&](Shard& shard, const market::MessageHeader* header) {
+            while (!shard.try_push(header, 0, 0)) {
+                ++stalls;
+                shard.notify();
+                std::this_thread::yield();
+            }
+        };
+
+        const uint64_t begin = market::now_ns();
+        for (size_t idx = 0; idx < offsets.size(); ++idx) {
+            const auto* header = reinterpret_cast<const market::MessageHeader*>(feed.data() + offsets[idx]);
+            const uint32_t symbol = market::MessageParser::symbol_of(header);
+            if (symbol == market::kAllSymbols) {
+                for (const auto& shard : shards) {
+                    push(*shard, header);
+                }
+            } else {
+                push(*shards[market::shard_of(symbol, shard_count)], header);
+            }
+            if ((idx & 63) == 63) {
+                for (const auto& shard : shards) {
+                    shard->notify();
+                }
+            }
+        }
+        for (const auto& shard : shards) {
+            shard->stop();
+        }
+        elapsed = market::now_ns() - begin;
+    }
+
+    bench::Result result;
+    result.name = "shard_scaling";
+    result.params = {{"shards", std::to_string(shard_count)}, {"symbols", std::to_string(cfg.symbols)},
+                     {"wait", market::wait_mode_name(cfg.wait)}, {"dispatch_stalls", std::to_string(stalls)},
+                     {"hardware_threads", std::to_string(std::thread::hardware_concurrency())}};
+    result.ops = offsets.size();
+    result.elapsed_ns = elapsed;
+    bench::print_json(result);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const BenchConfig cfg = parse_args(argc, argv);
+    bench::pin_current_thread(cfg.dispatch_cpu);
+
+    std::vector<uint32_t> offsets;
+    const std::vector<char> feed = build_feed(cfg, offsets);
+
+    for (const uint32_t shard_count : cfg.shard_counts) {
+        run(cfg, shard_count, feed, offsets);
+    }
+    return 0;
+}
@@ -0,0 +1,195 @@
+
+#include "bench_util.h"
+#include "../src/market_data.h"
+#include "../src/udp_receiver.h"
+#include "../src/utils/tsc_clock.h"
+#include "../src/wait_strategy.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct BenchConfig {
+    std::string multicast{"239.255.0.9"};
+    uint16_t port{5090};
+    uint64_t messages{20'000};
+    uint32_t rate{20'000};
+    size_t batch{8};
+    std::vector<market::WaitMode> modes{market::WaitMode::Yield, market::WaitMode::Spin,
+                                        market::WaitMode::BusyPoll, market::WaitMode::Backoff,
+                                        market::WaitMode::Block};
+};
+
+BenchConfig parse_args(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--multicast" && i + 1 < argc) {
+            cfg.multicast = argv[++i];
+        } else if (arg == "--port" && i + 1 < argc) {
+            cfg.port = static_cast<uint16_t>(std::stoi(argv[++i]));
+        } else if (arg == "--messages" && i + 1 < argc) {
+            cfg.messages = static_cast<uint64_t>(std::stoull(argv[++i]));
+        } else if (arg == "--rate" && i + 1 < argc) {
+            cfg.rate = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--batch" && i + 1 < argc) {
+            cfg.batch = static_cast<size_t>(std::stoull(argv[++i]));
+        } else if (arg == "--modes" && i + 1 < argc) {
+            cfg.modes.clear();
+            std::istringstream iss(argv[++i]);
+            std::string token;
+            market::WaitMode mode;
+            while (std::getline(iss, token, ',')) {
+                if (market::parse_wait_mode(token, mode)) {
+                    cfg.modes.push_back(mode);
+                }
+            }
+        }
+    }
+    return cfg;
+}
+
+uint64_t process_cpu_ns() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user);
+    auto to_ns = [](const FILETIME& time) {
+        return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 100;
+    };
+    return to_ns(kernel) + to_ns(user);
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto to_ns = [](const timeval& time) {
+        return static_cast<uint64_t>(time.tv_sec) * 1'000'000'000ULL + static_cast<uint64_t>(time.tv_usec) * 1'000;
+    };
+    return to_ns(usage.ru_utime) + to_ns(usage.ru_stime);
+#endif
+}
+
+void run(const BenchConfig& cfg, market::WaitMode mode, const market::TscClock& clock) {
+    market::ReceiverConfig rx;
+    rx.batch_size = cfg.batch;
+    rx.wait = mode;
+
+    auto ring = std::make_unique<market::RawMessageRing>();
+    market::Doorbell doorbell;
+    market::IdleWaiter waiter(mode, &doorbell, rx.spin_limit);
+
+    market::UDPReceiver receiver(cfg.multicast, cfg.port, rx);
+    receiver.start(*ring, waiter.needs_doorbell() ? &doorbell : nullptr);
+
+    const market::socket_handle_t sender = socket(AF_INET, SOCK_DGRAM, 0);
+    int ttl = 1;
+    setsockopt(sender, IPPROTO_IP, IP_MULTICAST_TTL, reinterpret_cast<char*>(&ttl), sizeof(ttl));
+
+    sockaddr_in endpoint{};
+    endpoint.sin_family = AF_INET;
+    endpoint.sin_port = htons(cfg.port);
+    inet_pton(AF_INET, cfg.multicast.c_str(), &endpoint.sin_addr);
+
+    std::atomic<bool> sending{true};
+    std::thread producer([&]() {
+        const auto interval = std::chrono::nanoseconds(1'000'000'000LL / (cfg.rate > 0 ? cfg.rate : 1));
+        auto next_send = std::chrono::steady_clock::now();
+
+        market::Quote quote{};
+        quote.header.msg_type = market::MSG_QUOTE;
+        quote.header.msg_len = sizeof(quote);
+        for (uint64_t sent = 0; sent < cfg.messages; ++sent) {
+            quote.header.sequence_num = static_cast<uint32_t>(sent + 1);
+            quote.header.timestamp_ns = market::rdtsc();
+            sendto(sender, reinterpret_cast<const char*>(&quote), sizeof(quote), 0,
+                   reinterpret_cast<const sockaddr*>(&endpoint), sizeof(endpoint));
+
+            next_send += interval;
+            std::this_thread::sleep_until(next_send);
+        }
+        sending.store(false, std::memory_order_release);
+    });
+
+    market::LatencyStats latency;
+    uint64_t received = 0;
+    const uint64_t cpu_begin = process_cpu_ns();
+    const uint64_t begin = market::now_ns();
+    const uint64_t drain_deadline_cycles = clock.cycles_for_ns(200'000'000ULL);
+    uint64_t idle_since = 0;
+
+    while (received < cfg.messages) {
+        const market::RawMessage* raw = ring->peek();
+        if (!raw) {
+            if (!sending.load(std::memory_order_acquire)) {
+                const uint64_t now = market::rdtsc();
+                if (idle_since == 0) {
+                    idle_since = now;
+                } else if (now - idle_since > drain_deadline_cycles) {
+                    break;
+                }
+            }
+            waiter.idle([&]() { return ring->size() > 0; });
+            continue;
+        }
+        waiter.reset();
+        idle_since = 0;
+
+        const auto* header = reinterpret_cast<const market::MessageHeader*>(raw->payload.data());
+        const uint64_t now = market::rdtsc();
+        latency.record(now > header->timestamp_ns ? now - header->timestamp_ns : 0);
+        ring->release();
+        ++received;
+    }
+
+    const uint64_t elapsed = market::now_ns() - begin;
+    const uint64_t cpu = process_cpu_ns() - cpu_begin;
+    producer.join();
+    receiver.stop();
+
+#ifdef _WIN32
+    closesocket(sender);
+#else
+    close(sender);
+#endif
+
+    std::ostringstream cpu_percent;
+    cpu_percent << (elapsed == 0 ? 0.0 : 100.0 * static_cast<double>(cpu) / static_cast<double>(elapsed));
+
+    bench::Result result;
+    result.name = "wait_strategy";
+    result.params = {{"wait", market::wait_mode_name(mode)}, {"batch", std::to_string(cfg.batch)},
+                     {"rate", std::to_string(cfg.rate)}, {"lost", std::to_string(cfg.messages - received)},
+                     {"cpu_percent", cpu_percent.str()}};
+    result.ops = received;
+    result.elapsed_ns = elapsed;
+    result.latency = latency.snapshot(clock.ns_per_cycle());
+    bench::print_json(result);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const BenchConfig cfg = parse_args(argc, argv);
+
+    market::TscClock clock;
+    clock.calibrate();
+
+    for (const market::WaitMode mode : cfg.modes) {
+        run(cfg, mode, clock);
+    }
+    return 0;
+}
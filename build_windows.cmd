@@ -7,23 +7,51 @@ set FLAGS=-std=c++17 -O3 -Wall -Wextra -I./src
 set LIBS=-lws2_32
 
 echo Building market_handler...
-%CXX% %FLAGS% src/main.cpp src/udp_receiver.cpp src/message_parser.cpp src/order_book.cpp -o market_handler.exe %LIBS%
+%CXX% %FLAGS% src/main.cpp src/udp_receiver.cpp src/message_parser.cpp src/order_book.cpp src/book_manager.cpp src/recovery.cpp src/capture.cpp src/replay.cpp src/trade_analytics.cpp src/shm_book.cpp -o market_handler.exe %LIBS%
 if errorlevel 1 exit /b 1
 
 echo Building feed_simulator...
-%CXX% %FLAGS% tools/feed_simulator.cpp -o feed_simulator.exe %LIBS%
+%CXX% %FLAGS% tools/feed_simulator.cpp src/order_book.cpp src/book_manager.cpp -o feed_simulator.exe %LIBS%
 if errorlevel 1 exit /b 1
 
 echo Building latency_benchmark...
-%CXX% %FLAGS% benchmarks/latency_benchmark.cpp -o latency_benchmark.exe %LIBS%
+%CXX% %FLAGS% benchmarks/latency_benchmark.cpp src/message_parser.cpp src/order_book.cpp -o latency_benchmark.exe %LIBS%
+if errorlevel 1 exit /b 1
+
+echo Building order_index_benchmark...
+%CXX% %FLAGS% benchmarks/order_index_benchmark.cpp -o order_index_benchmark.exe %LIBS%
+if errorlevel 1 exit /b 1
+
+echo Building ring_buffer_benchmark...
+%CXX% %FLAGS% benchmarks/ring_buffer_benchmark.cpp -o ring_buffer_benchmark.exe %LIBS%
+if errorlevel 1 exit /b 1
+
+echo Building wait_strategy_benchmark...
+%CXX% %FLAGS% benchmarks/wait_strategy_benchmark.cpp src/udp_receiver.cpp -o wait_strategy_benchmark.exe %LIBS%
+if errorlevel 1 exit /b 1
+
+echo Building shard_scaling_benchmark...
+%CXX% %FLAGS% benchmarks/shard_scaling_benchmark.cpp src/message_parser.cpp src/order_book.cpp src/book_manager.cpp src/trade_analytics.cpp -o shard_scaling_benchmark.exe %LIBS%
 if errorlevel 1 exit /b 1
 
 echo Building tests...
 %CXX% %FLAGS% tests/test_ring_buffer.cpp -o test_ring_buffer.exe %LIBS%
 if errorlevel 1 exit /b 1
-%CXX% %FLAGS% tests/test_parser.cpp -o test_parser.exe %LIBS%
+%CXX% %FLAGS% tests/test_parser.cpp src/message_parser.cpp -o test_parser.exe %LIBS%
+if errorlevel 1 exit /b 1
+%CXX% %FLAGS% tests/test_order_book.cpp src/order_book.cpp src/book_manager.cpp -o test_order_book.exe %LIBS%
+if errorlevel 1 exit /b 1
+%CXX% %FLAGS% tests/test_stats.cpp -o test_stats.exe %LIBS%
+if errorlevel 1 exit /b 1
+%CXX% %FLAGS% tests/test_recovery.cpp src/recovery.cpp src/message_parser.cpp src/order_book.cpp src/book_manager.cpp -o test_recovery.exe %LIBS%
+if errorlevel 1 exit /b 1
+%CXX% %FLAGS% tests/test_capture.cpp src/capture.cpp src/replay.cpp -o test_capture.exe %LIBS%
+if errorlevel 1 exit /b 1
+%CXX% %FLAGS% tests/test_trade_analytics.cpp src/trade_analytics.cpp -o test_trade_analytics.exe %LIBS%
+if errorlevel 1 exit /b 1
+%CXX% %FLAGS% tests/test_bbo_table.cpp src/order_book.cpp src/book_manager.cpp -o test_bbo_table.exe %LIBS%
 if errorlevel 1 exit /b 1
-%CXX% %FLAGS% tests/test_order_book.cpp -o test_order_book.exe %LIBS%
+%CXX% %FLAGS% tests/test_message_handler.cpp src/message_parser.cpp src/order_book.cpp src/book_manager.cpp src/trade_analytics.cpp -o test_message_handler.exe %LIBS%
 if errorlevel 1 exit /b 1
 
 echo Done. Binaries are in %cd%.
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "order_book.h"
+#include "seqlock.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace market {
+
+struct Bbo {
+    uint32_t symbol_id{0};
+    uint32_t sequence_num{0};
+    uint64_t timestamp_ns{0};
+    BookTop top;
+};
+
+class BboTable {
+public:
+
+    explicit BboTable(uint32_t max_symbol_id)
+        : size_(static_cast<size_t>(max_symbol_id) + 1), entries_(new Entry[size_]) {}
+
+    BboTable(const BboTable&) = delete;
+    BboTable& operator=(const BboTable&) = delete;
+
+    void publish(const Bbo& bbo) {
+        if (bbo.symbol_id < size_) {
+            entries_[bbo.symbol_id].quote.store(bbo);
+        }
+    }
+
+    bool read(uint32_t symbol_id, Bbo& out) const {
+        if (symbol_id >= size_ || entries_[symbol_id].quote.version() == 0) {
+            return false;
+        }
+        out = entries_[symbol_id].quote.load();
+        return true;
+    }
+
+    uint32_t version(uint32_t symbol_id) const {
+        return symbol_id < size_ ? entries_[symbol_id].quote.version() : 0;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    size_t bytes() const {
+        return size_ * sizeof(Entry);
+    }
+
+    void* data() {
+        return entries_.get();
+    }
+
+private:
+
+    struct alignas(64) Entry {
+        Seqlock<Bbo> quote;
+    };
+
+    static_assert(sizeof(Entry) == 64, "each symbol must own exactly one cache line");
+
+    size_t size_;
+    std::unique_ptr<Entry[]> entries_;
+};
+
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace market {
+
+struct BookConfig {
+    int64_t tick_size{1};
+    uint32_t ladder_levels{4096};
+    size_t order_capacity{2048};
+};
+
+}
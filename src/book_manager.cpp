@@ -0,0 +1,119 @@
+
+#include "book_manager.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace market {
+
+template <typename Book>
+BookManager<Book>::BookManager(uint32_t universe_size, uint32_t max_symbol_id, const BookConfig& config)
+    : slot_of_(static_cast<size_t>(max_symbol_id) + 1, kNoSlot),
+      symbol_of_(universe_size, 0),
+      books_(universe_size, Book(config)),
+      stale_(universe_size, 0),
+      tops_(universe_size) {
+
+    if (universe_size == 0) {
+        throw std::invalid_argument("BookManager universe size must be non-zero");
+    }
+}
+
+template <typename Book>
+uint32_t BookManager<Book>::register_symbol(uint32_t symbol_id) {
+    if (symbol_id >= slot_of_.size()) {
+        return kNoSlot;
+    }
+
+    if (slot_of_[symbol_id] == kNoSlot) {
+        if (next_slot_ == books_.size()) {
+            return kNoSlot;
+        }
+        slot_of_[symbol_id] = next_slot_;
+        symbol_of_[next_slot_] = symbol_id;
+        ++next_slot_;
+    }
+    return slot_of_[symbol_id];
+}
+
+template <typename Book>
+const Book* BookManager<Book>::find(uint32_t symbol_id) const {
+    const uint32_t slot = slot_of(symbol_id);
+    if (slot == kNoSlot) {
+        return nullptr;
+    }
+    return &books_[slot];
+}
+
+template <typename Book>
+int64_t BookManager<Book>::best_bid(uint32_t symbol_id) const {
+    const Book* book = find(symbol_id);
+    return book ? book->best_bid() : 0;
+}
+
+template <typename Book>
+int64_t BookManager<Book>::best_ask(uint32_t symbol_id) const {
+    const Book* book = find(symbol_id);
+    return book ? book->best_ask() : 0;
+}
+
+template <typename Book>
+int64_t BookManager<Book>::spread(uint32_t symbol_id) const {
+    const Book* book = find(symbol_id);
+    return book ? book->spread() : 0;
+}
+
+template <typename Book>
+uint32_t BookManager<Book>::slot_of(uint32_t symbol_id) const {
+    if (symbol_id >= slot_of_.size()) {
+        return kNoSlot;
+    }
+    return slot_of_[symbol_id];
+}
+
+template <typename Book>
+uint32_t BookManager<Book>::symbol_at(uint32_t slot) const {
+    return slot < next_slot_ ? symbol_of_[slot] : 0;
+}
+
+template <typename Book>
+uint32_t BookManager<Book>::active_symbols() const {
+    return next_slot_;
+}
+
+template <typename Book>
+uint32_t BookManager<Book>::universe_size() const {
+    return static_cast<uint32_t>(books_.size());
+}
+
+template <typename Book>
+uint64_t BookManager<Book>::unrouted_messages() const {
+    return unrouted_;
+}
+
+template <typename Book>
+uint64_t BookManager<Book>::rejected_orders() const {
+    uint64_t total = 0;
+    for (uint32_t slot = 0; slot < next_slot_; ++slot) {
+        total += books_[slot].rejected_orders();
+    }
+    return total;
+}
+
+template <typename Book>
+bool BookManager<Book>::is_stale(uint32_t symbol_id) const {
+    const uint32_t slot = slot_of(symbol_id);
+    return slot != kNoSlot && stale_[slot] != 0;
+}
+
+template <typename Book>
+uint32_t BookManager<Book>::stale_books() const {
+    return static_cast<uint32_t>(std::count(stale_.begin(), stale_.begin() + next_slot_, 1));
+}
+
+template class BookManager<OrderBook<MapLevels, StdOrderIndex>>;
+template class BookManager<OrderBook<TickLadder, StdOrderIndex>>;
+template class BookManager<OrderBook<MapLevels, FlatOrderIndex>>;
+template class BookManager<OrderBook<TickLadder, FlatOrderIndex>>;
+
+}
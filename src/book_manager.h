@@ -0,0 +1,207 @@
+#pragma once
+
+#include "bbo_table.h"
+#include "market_data.h"
+#include "message_handler.h"
+#include "order_book.h"
+#include "shm_book.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace market {
+
+template <typename Book = OrderBook<>>
+class BookManager : public MessageHandler<BookManager<Book>> {
+public:
+
+    static constexpr uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+
+    BookManager(uint32_t universe_size, uint32_t max_symbol_id, const BookConfig& config = BookConfig{});
+
+    BookManager(const BookManager&) = delete;
+    BookManager& operator=(const BookManager&) = delete;
+
+    uint32_t register_symbol(uint32_t symbol_id);
+
+    void publish_bbo(BboTable* table) {
+        bbo_ = table;
+    }
+
+    void publish_shm(ShmBookPublisher* publisher) {
+        shm_ = publisher;
+        depth_.assign(publisher != nullptr ? books_.size() : 0, ShmBook{});
+    }
+
+    Book* route(uint32_t symbol_id) {
+        if (symbol_id >= slot_of_.size()) {
+            ++unrouted_;
+            return nullptr;
+        }
+
+        uint32_t slot = slot_of_[symbol_id];
+        if (slot == kNoSlot) {
+
+            if (next_slot_ == books_.size()) {
+                ++unrouted_;
+                return nullptr;
+            }
+            slot = next_slot_++;
+            slot_of_[symbol_id] = slot;
+            symbol_of_[slot] = symbol_id;
+        }
+        return &books_[slot];
+    }
+
+    const Book* find(uint32_t symbol_id) const;
+
+    void on_order_add(const OrderAdd& msg) {
+        if (Book* book = route(msg.symbol_id)) {
+            book->on_order_add(msg);
+            publish(*book, msg.symbol_id, msg.header, Touch{msg.side, msg.price});
+        }
+    }
+
+    void on_order_cancel(const OrderCancel& msg) {
+        if (Book* book = route(msg.symbol_id)) {
+            const Touch touch = touched(*book, msg.order_id);
+            book->on_order_cancel(msg);
+            publish(*book, msg.symbol_id, msg.header, touch);
+        }
+    }
+
+    void on_order_execute(const OrderExecute& msg) {
+        if (Book* book = route(msg.symbol_id)) {
+            const Touch touch = touched(*book, msg.order_id);
+            book->on_order_execute(msg);
+            publish(*book, msg.symbol_id, msg.header, touch);
+        }
+    }
+
+    void on_order_modify(const OrderModify& msg) {
+        if (Book* book = route(msg.symbol_id)) {
+            const Touch touch = touched(*book, msg.order_id);
+            book->on_order_modify(msg);
+            publish(*book, msg.symbol_id, msg.header, touch);
+        }
+    }
+
+    void on_order_replace(const OrderReplace& msg) {
+        if (Book* book = route(msg.symbol_id)) {
+            Touch touch = touched(*book, msg.order_id);
+            if (touch.side == 'B') {
+                touch.price = std::max(touch.price, msg.price);
+            } else if (touch.side == 'S') {
+                touch.price = std::min(touch.price, msg.price);
+            }
+            book->on_order_replace(msg);
+            publish(*book, msg.symbol_id, msg.header, touch);
+        }
+    }
+
+    void on_quote(const Quote& msg) {
+        if (Book* book = route(msg.symbol_id)) {
+            book->on_quote(msg);
+            publish(*book, msg.symbol_id, msg.header);
+        }
+    }
+
+    void on_book_reset(const BookReset& msg) {
+        if (msg.symbol_id == kAllSymbols) {
+            std::fill(stale_.begin(), stale_.begin() + next_slot_, 1);
+            if (shm_ != nullptr) {
+                for (uint32_t slot = 0; slot < next_slot_; ++slot) {
+                    shm_->set_stale(symbol_of_[slot], depth_[slot], true);
+                }
+            }
+            return;
+        }
+
+        if (Book* book = route(msg.symbol_id)) {
+            const uint32_t slot = slot_of_[msg.symbol_id];
+            book->reset();
+            stale_[slot] = 0;
+            publish(*book, msg.symbol_id, msg.header);
+            if (shm_ != nullptr) {
+                shm_->set_stale(msg.symbol_id, depth_[slot], false);
+            }
+        }
+    }
+
+    void on_level_set(const LevelSet& msg) {
+        if (Book* book = route(msg.symbol_id)) {
+            book->on_level_set(msg);
+            publish(*book, msg.symbol_id, msg.header, Touch{msg.side, msg.price});
+        }
+    }
+
+    int64_t best_bid(uint32_t symbol_id) const;
+
+    int64_t best_ask(uint32_t symbol_id) const;
+
+    int64_t spread(uint32_t symbol_id) const;
+
+    uint32_t slot_of(uint32_t symbol_id) const;
+
+    uint32_t symbol_at(uint32_t slot) const;
+
+    uint32_t active_symbols() const;
+
+    uint32_t universe_size() const;
+
+    uint64_t unrouted_messages() const;
+
+    uint64_t rejected_orders() const;
+
+    bool is_stale(uint32_t symbol_id) const;
+
+    uint32_t stale_books() const;
+
+private:
+
+    struct Touch {
+        char side{0};
+        int64_t price{0};
+    };
+
+    Touch touched(const Book& book, uint64_t order_id) const {
+        const Order* order = shm_ != nullptr ? book.orders().find(order_id) : nullptr;
+        return order != nullptr ? Touch{order->side, order->price} : Touch{};
+    }
+
+    void publish(const Book& book, uint32_t symbol_id, const MessageHeader& header, Touch touch = Touch{}) {
+        if (shm_ != nullptr) {
+            shm_->update(symbol_id, header, book, depth_[slot_of_[symbol_id]], touch.side, touch.price);
+        }
+        if (bbo_ == nullptr) {
+            return;
+        }
+
+        const BookTop top = book.top();
+        Bbo& last = tops_[slot_of_[symbol_id]];
+        if (top == last.top) {
+            return;
+        }
+
+        last.symbol_id = symbol_id;
+        last.sequence_num = header.sequence_num;
+        last.timestamp_ns = header.timestamp_ns;
+        last.top = top;
+        bbo_->publish(last);
+    }
+
+    std::vector<uint32_t> slot_of_;
+    std::vector<uint32_t> symbol_of_;
+    std::vector<Book> books_;
+    std::vector<uint8_t> stale_;
+    std::vector<Bbo> tops_;
+    std::vector<ShmBook> depth_;
+    BboTable* bbo_{nullptr};
+    ShmBookPublisher* shm_{nullptr};
+    uint32_t next_slot_{0};
+    uint64_t unrouted_{0};
+};
+
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace market {
+
+struct ByteRecord {
+    const char* data{nullptr};
+    uint32_t len{0};
+    uint64_t recv_cycles{0};
+    uint64_t kernel_ns{0};
+};
+
+template <size_t Capacity>
+class ByteRing {
+
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be power of two");
+
+    struct RecordHeader {
+        uint32_t len;
+        uint32_t flags;
+        uint64_t recv_cycles;
+        uint64_t kernel_ns;
+    };
+
+    static_assert(sizeof(RecordHeader) == 24, "RecordHeader must stay compact");
+
+    static constexpr uint32_t kPaddingFlag = 1;
+    static constexpr size_t kAlign = 8;
+    static constexpr size_t mask_ = Capacity - 1;
+
+    alignas(64) std::atomic<uint64_t> head_{0};
+
+    alignas(64) uint64_t cached_tail_{0};
+    uint64_t reserved_at_{0};
+    size_t reserved_stride_{0};
+
+    alignas(64) std::atomic<uint64_t> tail_{0};
+
+    alignas(64) uint64_t cached_head_{0};
+    uint64_t read_at_{0};
+    size_t read_size_{0};
+
+    alignas(64) std::array<char, Capacity> buffer_;
+
+    static constexpr size_t record_size(size_t len) {
+        return (sizeof(RecordHeader) + len + kAlign - 1) & ~(kAlign - 1);
+    }
+
+    RecordHeader* header_at(uint64_t position) {
+        return reinterpret_cast<RecordHeader*>(buffer_.data() + (position & mask_));
+    }
+
+    const RecordHeader* header_at(uint64_t position) const {
+        return reinterpret_cast<const RecordHeader*>(buffer_.data() + (position & mask_));
+    }
+
+    size_t free_bytes(uint64_t head, size_t wanted) {
+        size_t available = Capacity - static_cast<size_t>(head - cached_tail_);
+        if (available < wanted) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            available = Capacity - static_cast<size_t>(head - cached_tail_);
+        }
+        return available;
+    }
+
+    bool place(size_t bytes, uint64_t& position) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        const size_t to_end = Capacity - (head & mask_);
+        const size_t skip = to_end < bytes ? to_end : 0;
+
+        if (free_bytes(head, skip + bytes) < skip + bytes) {
+            return false;
+        }
+
+        position = head + skip;
+        return true;
+    }
+
+    void write_padding(uint64_t head, uint64_t position) {
+        if (position != head && position - head >= sizeof(RecordHeader)) {
+            RecordHeader* padding = header_at(head);
+            padding->len = 0;
+            padding->flags = kPaddingFlag;
+        }
+    }
+
+public:
+
+    static constexpr size_t kMaxRecord = Capacity / 2;
+
+    ByteRing() = default;
+
+    ByteRing(const ByteRing&) = delete;
+    ByteRing& operator=(const ByteRing&) = delete;
+
+    char* reserve(size_t max_len) {
+        const size_t bytes = record_size(max_len);
+        if (bytes > kMaxRecord || !place(bytes, reserved_at_)) {
+            return nullptr;
+        }
+
+        reserved_stride_ = bytes;
+        return buffer_.data() + (reserved_at_ & mask_) + sizeof(RecordHeader);
+    }
+
+    void commit(size_t len, uint64_t recv_cycles, uint64_t kernel_ns = 0) {
+        assert(record_size(len) <= reserved_stride_);
+
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        write_padding(head, reserved_at_);
+
+        RecordHeader* header = header_at(reserved_at_);
+        header->len = static_cast<uint32_t>(len);
+        header->flags = 0;
+        header->recv_cycles = recv_cycles;
+        header->kernel_ns = kernel_ns;
+
+        head_.store(reserved_at_ + record_size(len), std::memory_order_release);
+    }
+
+    size_t reserve_batch(size_t count, size_t max_len, char** payloads) {
+        const size_t stride = record_size(max_len);
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        const size_t to_end = Capacity - (head & mask_);
+
+        size_t granted = count;
+        if (granted * stride > kMaxRecord) {
+            granted = kMaxRecord / stride;
+        }
+
+        size_t skip = to_end < granted * stride ? to_end : 0;
+        const size_t available = free_bytes(head, skip + granted * stride);
+        while (granted > 0 && available < skip + granted * stride) {
+            --granted;
+            skip = to_end < granted * stride ? to_end : 0;
+        }
+
+        if (granted == 0) {
+            return 0;
+        }
+
+        reserved_at_ = head + skip;
+        reserved_stride_ = stride;
+        for (size_t idx = 0; idx < granted; ++idx) {
+            payloads[idx] = buffer_.data() + ((reserved_at_ + idx * stride) & mask_) + sizeof(RecordHeader);
+        }
+        return granted;
+    }
+
+    void commit_batch(size_t count, const size_t* lens, const uint64_t* recv_cycles,
+                      const uint64_t* kernel_ns = nullptr) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        if (std::all_of(lens, lens + count, [](size_t len) { return len == 0; })) {
+            return;
+        }
+        write_padding(head, reserved_at_);
+
+        uint64_t write_at = reserved_at_;
+        for (size_t idx = 0; idx < count; ++idx) {
+            if (lens[idx] == 0) {
+                continue;
+            }
+            assert(record_size(lens[idx]) <= reserved_stride_);
+
+            const char* source = buffer_.data() + ((reserved_at_ + idx * reserved_stride_) & mask_) + sizeof(RecordHeader);
+            RecordHeader* header = header_at(write_at);
+            char* target = reinterpret_cast<char*>(header) + sizeof(RecordHeader);
+            if (target != source) {
+                std::memmove(target, source, lens[idx]);
+            }
+
+            header->len = static_cast<uint32_t>(lens[idx]);
+            header->flags = 0;
+            header->recv_cycles = recv_cycles[idx];
+            header->kernel_ns = kernel_ns ? kernel_ns[idx] : 0;
+            write_at += record_size(lens[idx]);
+        }
+
+        head_.store(write_at, std::memory_order_release);
+    }
+
+    bool peek(ByteRecord& record) {
+        uint64_t position = tail_.load(std::memory_order_relaxed);
+        if (position == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+        }
+
+        while (position != cached_head_) {
+            const size_t to_end = Capacity - (position & mask_);
+            if (to_end < sizeof(RecordHeader) || (header_at(position)->flags & kPaddingFlag)) {
+                position += to_end;
+                continue;
+            }
+
+            const RecordHeader* header = header_at(position);
+            record.data = reinterpret_cast<const char*>(header) + sizeof(RecordHeader);
+            record.len = header->len;
+            record.recv_cycles = header->recv_cycles;
+            record.kernel_ns = header->kernel_ns;
+
+            read_at_ = position;
+            read_size_ = record_size(header->len);
+            return true;
+        }
+        return false;
+    }
+
+    void release() {
+        tail_.store(read_at_ + read_size_, std::memory_order_release);
+    }
+
+    size_t size() const {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        const uint64_t tail = tail_.load(std::memory_order_acquire);
+        return static_cast<size_t>(head - tail);
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+};
+
+}
@@ -0,0 +1,290 @@
+
+#include "capture.h"
+#include "utils/cpu.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <malloc.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace market {
+
+namespace {
+
+constexpr size_t kDirectAlign = 4096;
+
+#ifdef _WIN32
+int open_file(const std::string& name, int flags) {
+    return _open(name.c_str(), flags | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+
+long long write_file(int fd, const char* data, size_t len) {
+    return _write(fd, data, static_cast<unsigned int>(len));
+}
+
+void truncate_file(int fd, uint64_t len) {
+    _chsize_s(fd, static_cast<long long>(len));
+}
+
+void close_file(int fd) {
+    _close(fd);
+}
+
+char* aligned_block(size_t bytes) {
+    return static_cast<char*>(_aligned_malloc(bytes, kDirectAlign));
+}
+#else
+int open_file(const std::string& name, int flags) {
+    return open(name.c_str(), flags, 0644);
+}
+
+long long write_file(int fd, const char* data, size_t len) {
+    return write(fd, data, len);
+}
+
+void truncate_file(int fd, uint64_t len) {
+    if (ftruncate(fd, static_cast<off_t>(len)) != 0) {
+        std::perror("capture ftruncate");
+    }
+}
+
+void close_file(int fd) {
+    close(fd);
+}
+
+char* aligned_block(size_t bytes) {
+    void* block = nullptr;
+    return posix_memalign(&block, kDirectAlign, bytes) == 0 ? static_cast<char*>(block) : nullptr;
+}
+#endif
+
+}
+
+void CaptureJournal::AlignedFree::operator()(char* block) const {
+#ifdef _WIN32
+    _aligned_free(block);
+#else
+    std::free(block);
+#endif
+}
+
+CaptureJournal::CaptureJournal(const CaptureConfig& config, const TscClock& clock)
+    : config_(config), clock_(clock), ring_(std::make_unique<CaptureRing>()) {
+
+    config_.block_bytes = std::max(kDirectAlign, config_.block_bytes / kDirectAlign * kDirectAlign);
+    block_.reset(aligned_block(config_.block_bytes));
+    if (!block_) {
+        throw std::runtime_error("Failed to allocate capture block");
+    }
+    prefault(ring_.get(), sizeof(*ring_));
+    prefault(block_.get(), config_.block_bytes);
+
+    if (!open_next()) {
+        throw std::runtime_error("Failed to open capture file " + file_name(config_.path, 0));
+    }
+}
+
+CaptureJournal::~CaptureJournal() {
+    stop();
+    finish_file();
+}
+
+void CaptureJournal::start() {
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this]() { run(); });
+}
+
+void CaptureJournal::stop() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+CaptureStats CaptureJournal::stats() const {
+    CaptureStats stats;
+    stats.records = records_.load(std::memory_order_relaxed);
+    stats.bytes = bytes_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.files = files_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::string CaptureJournal::file_name(const std::string& path, uint32_t index) {
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), ".%04u", index);
+    return path + suffix;
+}
+
+void CaptureJournal::run() {
+    uint64_t calibrated_at = now_ns();
+
+    while (true) {
+        ByteRecord record;
+        if (ring_->peek(record)) {
+            append(record);
+            ring_->release();
+            continue;
+        }
+
+        if (!running_.load(std::memory_order_acquire) && ring_->size() == 0) {
+            break;
+        }
+
+        const uint64_t now = now_ns();
+        if (now - calibrated_at >= 1'000'000'000ULL) {
+            clock_.recalibrate();
+            calibrated_at = now;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void CaptureJournal::append(const ByteRecord& record) {
+    const size_t bytes = sizeof(CaptureRecordHeader) + (config_.kernel_timestamps ? sizeof(uint64_t) : 0) + record.len;
+    const uint64_t written = file_bytes_ + block_used_;
+    if (config_.rotate_bytes != 0 && written > sizeof(CaptureFileHeader) && written + bytes > config_.rotate_bytes) {
+        finish_file();
+        open_next();
+    }
+
+    CaptureRecordHeader header{};
+    header.len = static_cast<uint16_t>(record.len);
+    header.recv_ns = clock_.to_realtime_ns(record.recv_cycles);
+    put(&header, sizeof(header));
+    if (config_.kernel_timestamps) {
+        put(&record.kernel_ns, sizeof(record.kernel_ns));
+    }
+    put(record.data, record.len);
+
+    records_.store(records_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    bytes_.store(bytes_.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+}
+
+void CaptureJournal::put(const void* data, size_t len) {
+    const char* bytes = static_cast<const char*>(data);
+    while (len > 0) {
+        const size_t chunk = std::min(len, config_.block_bytes - block_used_);
+        std::memcpy(block_.get() + block_used_, bytes, chunk);
+        block_used_ += chunk;
+        bytes += chunk;
+        len -= chunk;
+        if (block_used_ == config_.block_bytes) {
+            write_block(config_.block_bytes);
+            file_bytes_ += config_.block_bytes;
+            block_used_ = 0;
+        }
+    }
+}
+
+void CaptureJournal::write_block(size_t bytes) {
+    if (file_ < 0) {
+        return;
+    }
+
+    size_t done = 0;
+    while (done < bytes) {
+        const long long wrote = write_file(file_, block_.get() + done, bytes - done);
+        if (wrote > 0) {
+            done += static_cast<size_t>(wrote);
+            continue;
+        }
+#if defined(O_DIRECT)
+        if (wrote < 0 && errno == EINVAL && direct_.load(std::memory_order_relaxed)) {
+            open_flags_ &= ~O_DIRECT;
+            fcntl(file_, F_SETFL, fcntl(file_, F_GETFL) & ~O_DIRECT);
+            direct_.store(false, std::memory_order_relaxed);
+            continue;
+        }
+#endif
+        if (wrote < 0 && errno == EINTR) {
+            continue;
+        }
+        std::perror("capture write");
+        close_file(file_);
+        file_ = -1;
+        return;
+    }
+}
+
+void CaptureJournal::finish_file() {
+    if (file_ < 0) {
+        return;
+    }
+
+    const size_t used = block_used_;
+    if (used != 0) {
+        size_t padded = used;
+        if (direct_.load(std::memory_order_relaxed)) {
+            padded = (used + kDirectAlign - 1) / kDirectAlign * kDirectAlign;
+            std::memset(block_.get() + used, 0, padded - used);
+        }
+        write_block(padded);
+        file_bytes_ += used;
+        block_used_ = 0;
+        if (file_ >= 0 && padded != used) {
+            truncate_file(file_, file_bytes_);
+        }
+    }
+
+    if (file_ >= 0) {
+        close_file(file_);
+        file_ = -1;
+    }
+}
+
+bool CaptureJournal::open_next() {
+    const std::string name = file_name(config_.path, file_index_);
+
+    open_flags_ = O_WRONLY | O_CREAT | O_TRUNC;
+    file_ = -1;
+#if defined(O_DIRECT)
+    if (config_.direct_io) {
+        file_ = open_file(name, open_flags_ | O_DIRECT);
+        if (file_ >= 0) {
+            open_flags_ |= O_DIRECT;
+        }
+    }
+#endif
+    if (file_ < 0) {
+        file_ = open_file(name, open_flags_);
+    }
+    if (file_ < 0) {
+        std::perror(("capture open " + name).c_str());
+        return false;
+    }
+#if defined(O_DIRECT)
+    direct_.store((open_flags_ & O_DIRECT) != 0, std::memory_order_relaxed);
+#endif
+
+    CaptureFileHeader header{};
+    header.magic = kCaptureMagic;
+    header.version = kCaptureVersion;
+    header.flags = config_.kernel_timestamps ? kCaptureKernelTimestamps : 0;
+    header.created_ns = realtime_ns();
+    header.file_index = file_index_;
+
+    file_bytes_ = 0;
+    block_used_ = 0;
+    put(&header, sizeof(header));
+
+    ++file_index_;
+    files_.store(files_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return true;
+}
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "byte_ring.h"
+#include "market_data.h"
+#include "utils/tsc_clock.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace market {
+
+constexpr uint64_t kCaptureMagic = 0x3130504143444D4Dull;
+constexpr uint32_t kCaptureVersion = 1;
+constexpr uint32_t kCaptureKernelTimestamps = 1;
+
+#pragma pack(push, 1)
+
+struct CaptureFileHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint64_t created_ns;
+    uint32_t file_index;
+    uint32_t reserved;
+};
+
+struct CaptureRecordHeader {
+    uint16_t len;
+    uint16_t flags;
+    uint64_t recv_ns;
+};
+
+#pragma pack(pop)
+
+struct CaptureConfig {
+    std::string path;
+    uint64_t rotate_bytes{0};
+    bool kernel_timestamps{false};
+    bool direct_io{true};
+    size_t block_bytes{1u << 20};
+};
+
+struct CaptureStats {
+    uint64_t records{0};
+    uint64_t bytes{0};
+    uint64_t dropped{0};
+    uint32_t files{0};
+};
+
+using CaptureRing = ByteRing<(1u << 24)>;
+
+class CaptureJournal {
+public:
+
+    CaptureJournal(const CaptureConfig& config, const TscClock& clock);
+
+    ~CaptureJournal();
+
+    CaptureJournal(const CaptureJournal&) = delete;
+    CaptureJournal& operator=(const CaptureJournal&) = delete;
+
+    void start();
+
+    void stop();
+
+    bool record(const char* data, size_t len, uint64_t recv_cycles, uint64_t kernel_ns) {
+        char* slot = ring_->reserve(len);
+        if (slot == nullptr) {
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        std::memcpy(slot, data, len);
+        ring_->commit(len, recv_cycles, kernel_ns);
+        return true;
+    }
+
+    CaptureStats stats() const;
+
+    bool direct_io() const {
+        return direct_.load(std::memory_order_relaxed);
+    }
+
+    static std::string file_name(const std::string& path, uint32_t index);
+
+private:
+
+    struct AlignedFree {
+        void operator()(char* block) const;
+    };
+
+    void run();
+
+    void append(const ByteRecord& record);
+
+    void put(const void* data, size_t len);
+
+    void write_block(size_t bytes);
+
+    void finish_file();
+
+    bool open_next();
+
+    CaptureConfig config_;
+    TscClock clock_;
+    std::unique_ptr<CaptureRing> ring_;
+    std::unique_ptr<char, AlignedFree> block_;
+    size_t block_used_{0};
+    uint64_t file_bytes_{0};
+    uint32_t file_index_{0};
+    int file_{-1};
+    int open_flags_{0};
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> direct_{false};
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint32_t> files_{0};
+    alignas(64) std::atomic<uint64_t> dropped_{0};
+};
+
+}
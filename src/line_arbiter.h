@@ -0,0 +1,160 @@
+#pragma once
+
+#include "market_data.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace market {
+
+struct LineStats {
+    uint64_t datagrams{0};
+    uint64_t won{0};
+    uint64_t duplicates{0};
+    uint64_t lost{0};
+};
+
+class LineArbiter {
+public:
+
+    static constexpr size_t MaxLines = 2;
+
+    explicit LineArbiter(uint32_t window_bits = 16)
+        : window_(uint64_t{1} << std::clamp<uint32_t>(window_bits, 6, 30)), seen_(window_ / 64, 0) {}
+
+    bool accept(size_t line, const char* data, size_t len) {
+        LineCounters& counters = lines_[line];
+        bump(counters.datagrams);
+
+        uint64_t first = 0;
+        uint64_t last = 0;
+        if (!sequence_range(data, len, first, last)) {
+            bump(counters.won);
+            return true;
+        }
+
+        if (first < base_ && base_ - first > window_) {
+            restart();
+        }
+
+        if (first >= counters.next_expected) {
+            if (counters.next_expected != 0 && first > counters.next_expected) {
+                add(counters.lost, first - counters.next_expected);
+            }
+            counters.next_expected = last + 1;
+        }
+
+        if (first < base_ || (first < base_ + window_ && test(first))) {
+            bump(counters.duplicates);
+            return false;
+        }
+
+        mark(first, last);
+        bump(counters.won);
+        return true;
+    }
+
+    LineStats stats(size_t line) const {
+        const LineCounters& counters = lines_[line];
+        LineStats result;
+        result.datagrams = counters.datagrams.load(std::memory_order_relaxed);
+        result.won = counters.won.load(std::memory_order_relaxed);
+        result.duplicates = counters.duplicates.load(std::memory_order_relaxed);
+        result.lost = counters.lost.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    uint64_t window() const {
+        return window_;
+    }
+
+    static bool sequence_range(const char* data, size_t len, uint64_t& first, uint64_t& last) {
+        size_t offset = 0;
+        bool found = false;
+        while (offset + sizeof(MessageHeader) <= len) {
+            MessageHeader header;
+            std::memcpy(&header, data + offset, sizeof(header));
+            if (header.msg_len < sizeof(MessageHeader) || offset + header.msg_len > len) {
+                break;
+            }
+            if (!found) {
+                first = header.sequence_num;
+                found = true;
+            }
+            last = header.sequence_num;
+            offset += header.msg_len;
+        }
+        if (found && last < first) {
+            last = first;
+        }
+        return found;
+    }
+
+private:
+
+    struct LineCounters {
+        std::atomic<uint64_t> datagrams{0};
+        std::atomic<uint64_t> won{0};
+        std::atomic<uint64_t> duplicates{0};
+        std::atomic<uint64_t> lost{0};
+        uint64_t next_expected{0};
+    };
+
+    static void bump(std::atomic<uint64_t>& counter) {
+        add(counter, 1);
+    }
+
+    static void add(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    bool test(uint64_t sequence) const {
+        const uint64_t bit = sequence & (window_ - 1);
+        return (seen_[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    void mark(uint64_t first, uint64_t last) {
+        if (last - first >= window_) {
+            first = last - window_ + 1;
+        }
+        if (last >= base_ + window_) {
+            slide(last - window_ + 1);
+        }
+        for (uint64_t sequence = first; sequence <= last; ++sequence) {
+            const uint64_t bit = sequence & (window_ - 1);
+            seen_[bit >> 6] |= uint64_t{1} << (bit & 63);
+        }
+    }
+
+    void slide(uint64_t new_base) {
+        if (new_base - base_ >= window_) {
+            std::fill(seen_.begin(), seen_.end(), 0);
+        } else {
+            for (uint64_t sequence = base_; sequence < new_base; ++sequence) {
+                const uint64_t bit = sequence & (window_ - 1);
+                seen_[bit >> 6] &= ~(uint64_t{1} << (bit & 63));
+            }
+        }
+        base_ = new_base;
+    }
+
+    void restart() {
+        std::fill(seen_.begin(), seen_.end(), 0);
+        base_ = 0;
+        for (LineCounters& counters : lines_) {
+            counters.next_expected = 0;
+        }
+    }
+
+    uint64_t window_;
+    std::vector<uint64_t> seen_;
+    uint64_t base_{0};
+    std::array<LineCounters, MaxLines> lines_;
+};
+
+}
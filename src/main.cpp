@@ -1,17 +1,32 @@
 
+#include "bbo_table.h"
+#include "book_manager.h"
+#include "capture.h"
+#include "message_handler.h"
 #include "message_parser.h"
-#include "order_book.h"
+#include "recovery.h"
+#include "replay.h"
 #include "ring_buffer.h"
+#include "shard.h"
+#include "shm_book.h"
+#include "trade_analytics.h"
 #include "udp_receiver.h"
+#include "wait_strategy.h"
+#include "utils/cpu.h"
 #include "utils/stats.h"
 #include "utils/timestamp.h"
+#include "utils/tsc_clock.h"
 
 #include <array>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <csignal>
+#include <future>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <thread>
@@ -20,6 +35,15 @@
 
 namespace {
 
+#ifdef MARKET_MAP_BOOK
+using Book = market::OrderBook<market::MapLevels, market::StdOrderIndex>;
+#else
+using Book = market::OrderBook<market::TickLadder, market::FlatOrderIndex>;
+#endif
+
+using Books = market::BookManager<Book>;
+using Shard = market::ProcessorShard<Book>;
+
 static std::atomic<bool>* g_running_flag = nullptr;
 
 void signal_handler(int) {
@@ -33,6 +57,24 @@ struct Config {
     uint16_t port{5000};
     uint64_t duration_seconds{0};
     std::vector<uint32_t> watch_symbols;
+    uint32_t universe_size{1024};
+    uint32_t max_symbol_id{65535};
+    market::BookConfig book;
+    market::TradeAnalyticsConfig trades;
+    market::ReceiverConfig receiver;
+    market::ReorderConfig reorder{4096};
+    market::WaitMode processor_wait{market::WaitMode::Yield};
+    market::ThreadPlacement processor_placement;
+    int numa_node{-1};
+    uint32_t shards{1};
+    std::vector<int> shard_cpus;
+    bool byte_ring{false};
+    market::RecoveryConfig recovery;
+    market::CaptureConfig capture;
+    std::string replay_path;
+    double replay_speed{0.0};
+    std::string shm_name;
+    uint32_t shm_depth{5};
 };
 
 Config parse_args(int argc, char** argv) {
@@ -47,6 +89,100 @@ Config parse_args(int argc, char** argv) {
             cfg.port = static_cast<uint16_t>(std::stoi(argv[++i]));
         } else if (arg == "--duration" && i + 1 < argc) {
             cfg.duration_seconds = static_cast<uint64_t>(std::stoull(argv[++i]));
+        } else if (arg == "--universe" && i + 1 < argc) {
+            cfg.universe_size = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--max-symbol-id" && i + 1 < argc) {
+            cfg.max_symbol_id = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--tick-size" && i + 1 < argc) {
+            cfg.book.tick_size = static_cast<int64_t>(std::stoll(argv[++i]));
+        } else if (arg == "--ladder-levels" && i + 1 < argc) {
+            cfg.book.ladder_levels = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--orders-per-book" && i + 1 < argc) {
+            cfg.book.order_capacity = static_cast<size_t>(std::stoull(argv[++i]));
+        } else if (arg == "--bar-ms" && i + 1 < argc) {
+            cfg.trades.bar_ns = static_cast<uint64_t>(std::stoull(argv[++i])) * 1'000'000ULL;
+        } else if (arg == "--bar-history" && i + 1 < argc) {
+            cfg.trades.bar_history = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--byte-ring") {
+            cfg.byte_ring = true;
+        } else if (arg == "--batch" && i + 1 < argc) {
+            cfg.receiver.batch_size = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--rx-wait" && i + 1 < argc) {
+            if (!market::parse_wait_mode(argv[++i], cfg.receiver.wait)) {
+                std::cerr << "Unknown wait mode " << argv[i] << "\n";
+            }
+        } else if (arg == "--wait" && i + 1 < argc) {
+            if (!market::parse_wait_mode(argv[++i], cfg.processor_wait)) {
+                std::cerr << "Unknown wait mode " << argv[i] << "\n";
+            }
+        } else if (arg == "--spin-limit" && i + 1 < argc) {
+            cfg.receiver.spin_limit = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--busy-poll-us" && i + 1 < argc) {
+            cfg.receiver.busy_poll_us = std::stoi(argv[++i]);
+        } else if (arg == "--rx-cpu" && i + 1 < argc) {
+            cfg.receiver.placement.cpu = std::stoi(argv[++i]);
+        } else if (arg == "--proc-cpu" && i + 1 < argc) {
+            cfg.processor_placement.cpu = std::stoi(argv[++i]);
+        } else if (arg == "--rx-fifo" && i + 1 < argc) {
+            cfg.receiver.placement.fifo_priority = std::stoi(argv[++i]);
+        } else if (arg == "--proc-fifo" && i + 1 < argc) {
+            cfg.processor_placement.fifo_priority = std::stoi(argv[++i]);
+        } else if (arg == "--numa-node" && i + 1 < argc) {
+            cfg.numa_node = std::stoi(argv[++i]);
+        } else if (arg == "--shards" && i + 1 < argc) {
+            cfg.shards = std::max<uint32_t>(1, static_cast<uint32_t>(std::stoul(argv[++i])));
+        } else if (arg == "--shard-cpus" && i + 1 < argc) {
+
+            std::istringstream iss(argv[++i]);
+            std::string token;
+            while (std::getline(iss, token, ',')) {
+                if (!token.empty()) {
+                    cfg.shard_cpus.push_back(std::stoi(token));
+                }
+            }
+        } else if (arg == "--reorder-window" && i + 1 < argc) {
+            cfg.reorder.window = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--reorder-timeout-msgs" && i + 1 < argc) {
+            cfg.reorder.timeout_messages = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--reorder-timeout-us" && i + 1 < argc) {
+            cfg.reorder.timeout_ns = static_cast<uint64_t>(std::stoull(argv[++i])) * 1'000ULL;
+        } else if (arg == "--line-b" && i + 1 < argc) {
+
+            const std::string line = argv[++i];
+            const size_t colon = line.find(':');
+            cfg.receiver.line_b_ip = line.substr(0, colon);
+            if (colon != std::string::npos) {
+                cfg.receiver.line_b_port = static_cast<uint16_t>(std::stoi(line.substr(colon + 1)));
+            }
+        } else if (arg == "--recovery" && i + 1 < argc) {
+
+            const std::string server = argv[++i];
+            const size_t colon = server.find(':');
+            if (colon == std::string::npos) {
+                cfg.recovery.port = static_cast<uint16_t>(std::stoi(server));
+            } else {
+                cfg.recovery.host = server.substr(0, colon);
+                cfg.recovery.port = static_cast<uint16_t>(std::stoi(server.substr(colon + 1)));
+            }
+        } else if (arg == "--recovery-buffer" && i + 1 < argc) {
+            cfg.recovery.buffer_messages = static_cast<size_t>(std::stoull(argv[++i]));
+        } else if (arg == "--capture" && i + 1 < argc) {
+            cfg.capture.path = argv[++i];
+        } else if (arg == "--capture-rotate-mb" && i + 1 < argc) {
+            cfg.capture.rotate_bytes = static_cast<uint64_t>(std::stoull(argv[++i])) << 20;
+        } else if (arg == "--capture-kernel-ts") {
+            cfg.capture.kernel_timestamps = true;
+        } else if (arg == "--capture-buffered") {
+            cfg.capture.direct_io = false;
+        } else if (arg == "--replay" && i + 1 < argc) {
+            cfg.replay_path = argv[++i];
+        } else if (arg == "--replay-speed" && i + 1 < argc) {
+            const std::string speed = argv[++i];
+            cfg.replay_speed = speed == "max" ? 0.0 : std::stod(speed);
+        } else if (arg == "--shm" && i + 1 < argc) {
+            cfg.shm_name = argv[++i];
+        } else if (arg == "--shm-depth" && i + 1 < argc) {
+            cfg.shm_depth = static_cast<uint32_t>(std::stoul(argv[++i]));
         } else if (arg == "--symbols" && i + 1 < argc) {
 
             const std::string list = argv[++i];
@@ -74,6 +210,103 @@ std::string format_price(int64_t price) {
     return oss.str();
 }
 
+struct PacketLatency : market::MessageHandler<PacketLatency> {
+    market::LatencyStats latency;
+    market::LatencyStats queue;
+    market::LatencyStats wire;
+    uint64_t processing{0};
+    uint64_t queued{0};
+    uint64_t on_wire{0};
+    bool kernel_stamped{false};
+
+    void on_header(const market::MessageHeader&) {
+        latency.record(processing);
+        if (kernel_stamped) {
+            queue.record(queued);
+            wire.record(on_wire);
+        }
+    }
+
+    void reset() {
+        latency.reset();
+        queue.reset();
+        wire.reset();
+    }
+};
+
+class WatchTracker : public market::MessageHandler<WatchTracker> {
+public:
+
+    explicit WatchTracker(const std::vector<uint32_t>& symbols)
+        : watched_(symbols.begin(), symbols.end()) {}
+
+    void on_quote(const market::Quote& msg) {
+        if (watched_.count(msg.symbol_id)) {
+            last_symbol_ = msg.symbol_id;
+        }
+    }
+
+    uint32_t last_symbol() const {
+        return last_symbol_;
+    }
+
+    void reset() {
+        last_symbol_ = 0;
+    }
+
+private:
+
+    std::unordered_set<uint32_t> watched_;
+    uint32_t last_symbol_{0};
+};
+
+void print_bbo(const market::BboTable& table, uint32_t symbol) {
+    market::Bbo bbo;
+    if (!table.read(symbol, bbo)) {
+        return;
+    }
+
+    const market::BookTop& top = bbo.top;
+    const int64_t spread = top.bid_price != 0 && top.ask_price != 0 ? top.ask_price - top.bid_price : 0;
+    std::cout << "[BBO " << symbol << "] Bid: $" << format_price(top.bid_price) << " (" << top.bid_size << ") x $"
+              << format_price(top.ask_price) << " (" << top.ask_size << ") (spread: $" << format_price(spread)
+              << ", seq " << bbo.sequence_num << ")\n";
+}
+
+void print_trade_stats(const market::TradeAnalytics& analytics, uint32_t symbol) {
+    market::TradeSnapshot trades;
+    if (!analytics.snapshot(symbol, trades) || trades.trades == 0) {
+        return;
+    }
+
+    std::ostringstream split;
+    split << std::fixed << std::setprecision(1) << 100.0 * static_cast<double>(trades.buy_volume) / trades.volume
+          << "% buy / " << 100.0 * static_cast<double>(trades.sell_volume) / trades.volume << "% sell";
+
+    const market::OhlcvBar& bar = trades.bar;
+    std::cout << "[TRADES " << symbol << "] Last: $" << format_price(trades.last_price) << " x " << trades.last_size
+              << ", VWAP: $" << format_price(std::llround(trades.vwap())) << ", Volume: " << trades.volume << " ("
+              << split.str() << ")\n";
+    std::cout << "  Bar (" << analytics.config().bar_ns / 1'000'000 << "ms): O $" << format_price(bar.open)
+              << " H $" << format_price(bar.high) << " L $" << format_price(bar.low) << " C $"
+              << format_price(bar.close) << " V " << bar.volume << " (" << bar.trades << " trades)\n";
+}
+
+void print_line_stats(const market::UDPReceiver& receiver) {
+    for (size_t line = 0; line < receiver.line_count(); ++line) {
+        const market::LineStats stats = receiver.line_stats(line);
+        std::cout << "  Line " << static_cast<char>('A' + line) << ":             " << stats.datagrams
+                  << " datagrams, " << stats.won << " won, " << stats.duplicates << " duplicates, "
+                  << stats.lost << " lost\n";
+    }
+}
+
+void print_capture_stats(const market::CaptureJournal& capture) {
+    const market::CaptureStats stats = capture.stats();
+    std::cout << "  Capture:            " << stats.records << " datagrams, " << (stats.bytes >> 20) << "MB in "
+              << stats.files << " file(s), " << stats.dropped << " dropped (writer behind)\n";
+}
+
 }
 
 int main(int argc, char** argv) {
@@ -81,14 +314,152 @@ int main(int argc, char** argv) {
     const Config cfg = parse_args(argc, argv);
 
     std::cout << "=== Market Data Handler ===\n";
-    std::cout << "Joining multicast " << cfg.multicast_ip << ":" << cfg.port << "\n\n";
+    std::unique_ptr<market::CaptureReader> replay;
+    if (!cfg.replay_path.empty()) {
+        replay = std::make_unique<market::CaptureReader>(cfg.replay_path);
+        std::cout << "Replaying " << cfg.replay_path << " (" << replay->files() << " file(s), ";
+        if (cfg.replay_speed <= 0.0) {
+            std::cout << "as fast as possible)\n\n";
+        } else {
+            std::cout << cfg.replay_speed << "x original timing)\n\n";
+        }
+    } else {
+        std::cout << "Joining multicast " << cfg.multicast_ip << ":" << cfg.port << "\n\n";
+    }
+
+    const int memory_node =
+        cfg.numa_node >= 0 ? cfg.numa_node : market::numa_node_of_cpu(cfg.processor_placement.cpu);
+
+    std::unique_ptr<market::RawMessageRing> slot_ring;
+    std::unique_ptr<market::DatagramRing> byte_ring;
+    std::unique_ptr<Books> books;
+    std::unique_ptr<market::BboTable> bbo;
+    std::unique_ptr<market::ShmBookPublisher> shm;
+    std::unique_ptr<market::TradeAnalytics> trades;
+    std::vector<std::unique_ptr<Shard>> shards;
+    {
+        market::ScopedMemoryPolicy policy(memory_node);
+        if (!replay) {
+            if (cfg.byte_ring) {
+                byte_ring = std::make_unique<market::DatagramRing>();
+                market::prefault(byte_ring.get(), sizeof(*byte_ring));
+            } else {
+                slot_ring = std::make_unique<market::RawMessageRing>();
+                market::prefault(slot_ring.get(), sizeof(*slot_ring));
+            }
+        }
+
+        bbo = std::make_unique<market::BboTable>(cfg.max_symbol_id);
+        market::prefault(bbo->data(), bbo->bytes());
+        if (!cfg.shm_name.empty()) {
+            shm = std::make_unique<market::ShmBookPublisher>(cfg.shm_name, cfg.max_symbol_id, cfg.shm_depth);
+        }
 
-    market::SPSCRingBuffer<market::RawMessage, 65536> ring;
+        if (cfg.shards > 1) {
+            for (uint32_t idx = 0; idx < cfg.shards; ++idx) {
+                market::ShardConfig shard_cfg;
+                shard_cfg.universe_size = std::max<uint32_t>(1, (cfg.universe_size * 3 / 2 + cfg.shards - 1) / cfg.shards);
+                shard_cfg.max_symbol_id = cfg.max_symbol_id;
+                shard_cfg.book = cfg.book;
+                shard_cfg.trades = cfg.trades;
+                shard_cfg.bbo = bbo.get();
+                shard_cfg.shm = shm.get();
+                shard_cfg.wait = cfg.processor_wait;
+                shard_cfg.spin_limit = cfg.receiver.spin_limit;
+                if (idx < cfg.shard_cpus.size()) {
+                    shard_cfg.placement.cpu = cfg.shard_cpus[idx];
+                }
+                for (const uint32_t symbol : cfg.watch_symbols) {
+                    if (market::shard_of(symbol, cfg.shards) == idx) {
+                        shard_cfg.watch_symbols.push_back(symbol);
+                    }
+                }
+                shards.push_back(std::make_unique<Shard>(shard_cfg));
+            }
+        } else {
+            books = std::make_unique<Books>(cfg.universe_size, cfg.max_symbol_id, cfg.book);
+            books->publish_bbo(bbo.get());
+            books->publish_shm(shm.get());
+            trades = std::make_unique<market::TradeAnalytics>(cfg.universe_size, cfg.max_symbol_id, cfg.trades);
+        }
+
+        std::cout << "Memory: ring and books "
+                  << (policy.applied() ? "preferred on node " + std::to_string(memory_node) : std::string("on default policy"))
+                  << ", ring prefaulted\n";
+    }
+
+    market::TscClock tsc;
+    tsc.calibrate();
+    std::cout << "TSC: " << tsc.ghz() << " GHz"
+              << (tsc.invariant() ? "" : " (not invariant, drift-corrected each interval)") << "\n\n";
+
+    if (books) {
+        for (const uint32_t symbol : cfg.watch_symbols) {
+            if (books->register_symbol(symbol) == Books::kNoSlot) {
+                std::cerr << "Symbol " << symbol << " does not fit the configured universe\n";
+            }
+        }
+
+        std::cout << "Book universe: " << books->universe_size() << " symbols (max id "
+                  << cfg.max_symbol_id << "), " << cfg.book.order_capacity << " orders per book\n\n";
+    } else {
+        std::cout << "Book universe: " << cfg.shards << " shards (max id " << cfg.max_symbol_id << "), "
+                  << cfg.book.order_capacity << " orders per book\n";
+        for (size_t idx = 0; idx < shards.size(); ++idx) {
+            shards[idx]->start();
+            std::cout << "Shard " << idx << " thread:   " << shards[idx]->placement() << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << "Receiver: batch " << cfg.receiver.batch_size << ", " << market::wait_mode_name(cfg.receiver.wait)
+              << " wait; processor: " << market::wait_mode_name(cfg.processor_wait) << " wait\n";
+    if (cfg.reorder.window != 0) {
+        std::cout << "Reorder window: " << cfg.reorder.window << " messages, timeout after "
+                  << cfg.reorder.timeout_messages << " messages or " << cfg.reorder.timeout_ns / 1'000 << "us\n";
+    }
+    if (!cfg.receiver.line_b_ip.empty()) {
+        std::cout << "A/B arbitration: line A " << cfg.multicast_ip << ":" << cfg.port << ", line B "
+                  << cfg.receiver.line_b_ip << ":"
+                  << (cfg.receiver.line_b_port != 0 ? cfg.receiver.line_b_port : cfg.port) << "\n";
+    }
+    if (cfg.recovery.port != 0) {
+        std::cout << "Snapshot recovery: " << cfg.recovery.host << ":" << cfg.recovery.port << ", buffering up to "
+                  << cfg.recovery.buffer_messages << " live messages\n";
+    }
 
-    market::UDPReceiver receiver(cfg.multicast_ip, cfg.port);
-    receiver.start(ring);
+    std::unique_ptr<market::CaptureJournal> capture;
+    if (!cfg.capture.path.empty()) {
+        capture = std::make_unique<market::CaptureJournal>(cfg.capture, tsc);
+        capture->start();
+        std::cout << "Capture: " << market::CaptureJournal::file_name(cfg.capture.path, 0)
+                  << (capture->direct_io() ? " (O_DIRECT" : " (buffered") << ", "
+                  << cfg.capture.block_bytes / 1024 << "KB blocks"
+                  << (cfg.capture.rotate_bytes != 0 ? ", rotating every " + std::to_string(cfg.capture.rotate_bytes >> 20) + "MB"
+                                                    : std::string())
+                  << (cfg.capture.kernel_timestamps ? ", kernel timestamps" : "") << ")\n";
+    }
+    if (shm) {
+        std::cout << "Shared memory: " << shm->name() << " (top " << shm->depth() << " levels, "
+                  << (shm->bytes() >> 20) << "MB region)\n";
+    }
+    std::cout << "\n";
+
+    market::Doorbell doorbell;
+    market::IdleWaiter waiter(cfg.processor_wait, &doorbell, cfg.receiver.spin_limit);
+    market::Doorbell* wakeup = waiter.needs_doorbell() ? &doorbell : nullptr;
+
+    std::unique_ptr<market::UDPReceiver> receiver;
+    if (!replay) {
+        receiver = std::make_unique<market::UDPReceiver>(cfg.multicast_ip, cfg.port, cfg.receiver);
+        if (byte_ring) {
+            receiver->start(*byte_ring, wakeup);
+        } else {
+            receiver->start(*slot_ring, wakeup);
+        }
+        std::cout << "Receiver thread:  " << receiver->placement() << "\n";
+    }
 
-    std::unordered_set<uint32_t> watched(cfg.watch_symbols.begin(), cfg.watch_symbols.end());
 
     std::atomic<bool> running{true};
     g_running_flag = &running;
@@ -96,119 +467,328 @@ int main(int argc, char** argv) {
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
 
+    std::promise<std::string> processor_placed;
     std::thread processor([&]() {
 
-        market::MessageParser parser;
-        market::OrderBook order_book;
-        market::LatencyStats latency_stats;
+        processor_placed.set_value(market::apply_thread_placement(cfg.processor_placement));
 
-        uint64_t interval_start = market::now_ns();
+        market::MessageParser parser(cfg.reorder);
+        std::unique_ptr<market::RecoveryCoordinator> recovery;
+        if (cfg.recovery.port != 0) {
+            recovery = std::make_unique<market::RecoveryCoordinator>(cfg.recovery);
+        }
+        Books* book_manager = books.get();
+        PacketLatency packet_stats;
+        WatchTracker watch(cfg.watch_symbols);
+        std::optional<market::HandlerChain<PacketLatency, market::TradeAnalytics, Books>> handlers;
+        if (book_manager != nullptr) {
+            handlers.emplace(packet_stats, *trades, *book_manager);
+        }
+
+        market::TscClock clock = tsc;
+        uint64_t interval_cycles = clock.cycles_for_ns(1'000'000'000ULL);
+        uint64_t interval_start = market::rdtsc();
         uint64_t interval_messages = 0;
+        uint64_t interval_packets = 0;
         uint64_t interval_bytes = 0;
-        uint32_t last_watched_symbol = 0;
 
-        while (running.load(std::memory_order_acquire) || ring.size() > 0) {
+        const auto shard_count = static_cast<uint32_t>(shards.size());
+        const bool notify_shards = waiter.needs_doorbell();
+        const bool latency_measured = !replay || shard_count != 0;
+        uint64_t stats_epoch = 0;
+        uint64_t dispatch_stalls = 0;
 
-            market::RawMessage raw;
-            if (!ring.try_pop(raw)) {
-                std::this_thread::yield();
-                continue;
-            }
-
-            const market::MessageHeader* header = parser.parse(raw);
-            if (!header) {
-                continue;
-            }
+        uint64_t replay_messages = 0;
+        uint64_t packet_recv_cycles = 0;
+        uint64_t packet_kernel_cycles = 0;
 
-            const uint64_t latency = market::now_ns() - raw.recv_timestamp_ns;
-            latency_stats.record(latency);
+        auto on_message = [&](const market::MessageHeader* header) {
 
-            interval_messages += 1;
-            interval_bytes += raw.len;
-
-            switch (header->msg_type) {
-                case market::MSG_QUOTE: {
-
-                    const auto* quote = parser.as<market::Quote>(header);
-                    order_book.on_quote(*quote);
+            if (shard_count != 0) {
+                auto push = [&](Shard& shard) {
+                    while (!shard.try_push(header, packet_recv_cycles, packet_kernel_cycles)) {
+                        ++dispatch_stalls;
+                        shard.notify();
+                        std::this_thread::yield();
+                    }
+                };
 
-                    if (watched.count(quote->symbol_id)) {
-                        last_watched_symbol = quote->symbol_id;
+                const uint32_t symbol = market::MessageParser::symbol_of(header);
+                if (symbol == market::kAllSymbols) {
+                    for (const auto& shard : shards) {
+                        push(*shard);
                     }
-                    break;
+                } else {
+                    push(*shards[market::shard_of(symbol, shard_count)]);
                 }
+                return;
+            }
 
-                case market::MSG_ORDER_ADD: {
-
-                    order_book.on_order_add(*parser.as<market::OrderAdd>(header));
-                    break;
-                }
+            handlers->on_message(header);
+        };
 
-                case market::MSG_ORDER_CANCEL: {
+        auto deliver = [&](const market::MessageHeader* header) {
 
-                    order_book.on_order_cancel(*parser.as<market::OrderCancel>(header));
-                    break;
-                }
+            interval_messages += 1;
+            replay_messages += 1;
+            watch.on_message(header);
 
-                case market::MSG_TRADE: {
+            if (recovery) {
+                recovery->on_message(header, on_message);
+            } else {
+                on_message(header);
+            }
+        };
 
-                    break;
+        auto notify_all_shards = [&]() {
+            if (notify_shards) {
+                for (const auto& shard : shards) {
+                    shard->notify();
                 }
+            }
+        };
+
+        auto poll_recovery = [&]() {
+            if (recovery && recovery->poll(on_message) != 0) {
+                notify_all_shards();
+            }
+        };
 
-                default: {
+        auto handle_packet = [&](const char* data, size_t len, uint64_t recv_cycles, uint64_t kernel_ns,
+                                 uint64_t now_cycles) {
 
-                    break;
-                }
+            interval_packets += 1;
+            interval_bytes += len;
+            if (capture) {
+                capture->record(data, len, recv_cycles, kernel_ns);
             }
+            packet_recv_cycles = recv_cycles;
+            packet_kernel_cycles = kernel_ns != 0 ? clock.cycles_at_realtime(kernel_ns) : 0;
+            packet_stats.kernel_stamped = packet_kernel_cycles != 0;
+            packet_stats.processing = now_cycles > recv_cycles ? now_cycles - recv_cycles : 0;
+            packet_stats.queued = recv_cycles > packet_kernel_cycles ? recv_cycles - packet_kernel_cycles : 0;
+            packet_stats.on_wire = now_cycles > packet_kernel_cycles ? now_cycles - packet_kernel_cycles : 0;
+
+            parser.parse_packet(data, len, deliver);
+            poll_recovery();
+            notify_all_shards();
+        };
+
+        auto expire_held = [&]() {
+            if (parser.held_messages() != 0 && parser.expire(deliver) != 0) {
+                notify_all_shards();
+            }
+            poll_recovery();
+        };
+
+        auto report_interval = [&](uint64_t now_cycles) {
+
+            if (now_cycles - interval_start >= interval_cycles) {
+                const double elapsed_s = static_cast<double>(clock.to_ns(now_cycles - interval_start)) / 1e9;
+
+                uint32_t active_books = 0;
+                uint64_t unrouted = 0;
+                uint64_t rejected = 0;
+                uint32_t stale_books = 0;
+                uint32_t lagging_shards = 0;
+                std::vector<uint64_t> shard_messages;
+
+                if (shard_count != 0) {
+                    ++stats_epoch;
+                    for (const auto& shard : shards) {
+                        if (stats_epoch > 1 && shard->stats_ready(stats_epoch - 1)) {
+                            const market::ShardStats& stats = shard->stats(stats_epoch - 1);
+                            packet_stats.latency.merge(stats.latency);
+                            packet_stats.queue.merge(stats.queue);
+                            packet_stats.wire.merge(stats.wire);
+                            active_books += stats.active_books;
+                            unrouted += stats.unrouted;
+                            rejected += stats.rejected;
+                            stale_books += stats.stale_books;
+                            shard_messages.push_back(stats.messages);
+                        } else if (stats_epoch > 1) {
+                            ++lagging_shards;
+                        }
+                        shard->request_stats(stats_epoch);
+                    }
+                } else {
+                    active_books = book_manager->active_symbols();
+                    unrouted = book_manager->unrouted_messages();
+                    rejected = book_manager->rejected_orders();
+                    stale_books = book_manager->stale_books();
+                }
 
-            const uint64_t now = market::now_ns();
-            if (now - interval_start >= 1'000'000'000ULL) {
-                const double elapsed_s = static_cast<double>(now - interval_start) / 1e9;
-                const auto snap = latency_stats.snapshot();
+                const auto snap = packet_stats.latency.snapshot(clock.ns_per_cycle());
 
-                std::cout << "[BBO] Bid: $" << format_price(order_book.best_bid())
-                          << " x $" << format_price(order_book.best_ask())
-                          << " (spread: $" << format_price(order_book.spread()) << ")\n";
+                for (const uint32_t symbol : cfg.watch_symbols) {
+                    print_bbo(*bbo, symbol);
+                }
+                for (const uint32_t symbol : cfg.watch_symbols) {
+                    print_trade_stats(shard_count != 0 ? shards[market::shard_of(symbol, shard_count)]->trades() : *trades,
+                                      symbol);
+                }
 
-                if (last_watched_symbol != 0) {
-                    std::cout << "  Watching symbol " << last_watched_symbol << " updates\n";
+                if (watch.last_symbol() != 0) {
+                    std::cout << "  Watching symbol " << watch.last_symbol() << " updates\n";
                 }
 
                 std::cout << "Stats (last " << elapsed_s << "s):\n";
                 std::cout << "  Messages received:  " << interval_messages << "\n";
+                std::cout << "  Packets received:   " << interval_packets << " ("
+                          << (interval_packets == 0 ? 0.0 : static_cast<double>(interval_messages) / interval_packets)
+                          << " msg/packet)\n";
                 std::cout << "  Throughput:         " << (interval_messages / elapsed_s) << " msg/sec\n";
-                std::cout << "  Avg latency:        " << snap.avg_ns << "ns\n";
-                std::cout << "  P50 latency:        " << snap.p50_ns << "ns\n";
-                std::cout << "  P95 latency:        " << snap.p95_ns << "ns\n";
-                std::cout << "  P99 latency:        " << snap.p99_ns << "ns\n";
-                std::cout << "  P99.9 latency:      " << snap.p999_ns << "ns\n";
+                if (latency_measured && snap.sample_count != 0) {
+                    std::cout << "  Avg latency:        " << snap.avg_ns << "ns\n";
+                    std::cout << "  P50 latency:        " << snap.p50_ns << "ns\n";
+                    std::cout << "  P95 latency:        " << snap.p95_ns << "ns\n";
+                    std::cout << "  P99 latency:        " << snap.p99_ns << "ns\n";
+                    std::cout << "  P99.9 latency:      " << snap.p999_ns << "ns\n";
+                } else {
+                    std::cout << "  Latency:            "
+                              << (latency_measured ? "no samples" : "not measured (replay has no receive stamps)") << "\n";
+                }
+
+                if (packet_stats.wire.histogram().total_count() > 0) {
+                    const auto queue = packet_stats.queue.snapshot(clock.ns_per_cycle());
+                    const auto wire = packet_stats.wire.snapshot(clock.ns_per_cycle());
+                    std::cout << "  Socket queue:       P50 " << queue.p50_ns << "ns  P99 " << queue.p99_ns
+                              << "ns  P99.9 " << queue.p999_ns << "ns\n";
+                    std::cout << "  Wire-to-book:       P50 " << wire.p50_ns << "ns  P99 " << wire.p99_ns
+                              << "ns  P99.9 " << wire.p999_ns << "ns\n";
+                }
                 std::cout << "  Sequence gaps:      " << parser.sequence_gaps() << "\n";
                 std::cout << "  Parse errors:       " << parser.invalid_messages() << "\n";
+                std::cout << "  Reordered:          " << parser.reordered_messages() << " (" << parser.gap_timeouts()
+                          << " gap timeouts, " << parser.duplicate_messages() << " late/duplicate dropped)\n";
+                std::cout << "  Active books:       " << active_books << "\n";
+                std::cout << "  Unrouted messages:  " << unrouted << "\n";
+                std::cout << "  Rejected orders:    " << rejected << "\n";
+                if (recovery) {
+                    std::cout << "  Recovery:           " << recovery->recoveries() << " gaps, "
+                              << recovery->snapshots_applied() << " snapshots applied (" << recovery->stale_snapshots() << " too old), "
+                              << recovery->replayed_messages()
+                              << " replayed, " << stale_books << " stale books"
+                              << (recovery->recovering() ? " (recovering, " + std::to_string(recovery->buffered_messages()) +
+                                                               " buffered)"
+                                                         : std::string())
+                              << "\n";
+                }
+                if (receiver && receiver->line_count() > 1) {
+                    print_line_stats(*receiver);
+                }
+                if (capture) {
+                    print_capture_stats(*capture);
+                }
+
+                if (shard_count != 0) {
+                    std::cout << "  Shard messages:    ";
+                    for (const uint64_t count : shard_messages) {
+                        std::cout << " " << count;
+                    }
+                    std::cout << (lagging_shards != 0 ? " (" + std::to_string(lagging_shards) + " lagging)" : std::string())
+                              << "\n";
+                    std::cout << "  Dispatch stalls:    " << dispatch_stalls << "\n";
+                }
 
                 const auto histogram = snap.histogram;
                 const std::array<std::string, 5> labels = {
                     "<500ns", "500ns-1us", "1us-2us", "2us-5us", ">5us"};
 
-                std::cout << "Latency Distribution:\n";
-                for (size_t idx = 0; idx < histogram.size(); ++idx) {
+                if (latency_measured && snap.sample_count != 0) {
+                    std::cout << "Latency Distribution:\n";
+                    for (size_t idx = 0; idx < histogram.size(); ++idx) {
 
-                    const double percent =
-                        interval_messages == 0 ? 0.0 : (static_cast<double>(histogram[idx]) / interval_messages) * 100.0;
-                    std::cout << "  " << labels[idx] << ": " << std::fixed << std::setprecision(1) << percent
-                              << "% (" << histogram[idx] << ")\n";
+                        const double percent =
+                            snap.sample_count == 0 ? 0.0 : (static_cast<double>(histogram[idx]) / snap.sample_count) * 100.0;
+                        std::cout << "  " << labels[idx] << ": " << std::fixed << std::setprecision(1) << percent
+                                  << "% (" << histogram[idx] << ")\n";
+                    }
                 }
 
                 interval_messages = 0;
+                interval_packets = 0;
                 interval_bytes = 0;
-                interval_start = now;
-                last_watched_symbol = 0;
+                interval_start = now_cycles;
+                watch.reset();
+                dispatch_stalls = 0;
 
-                parser = market::MessageParser();
-                latency_stats.reset();
+                parser.reset_counters();
+                packet_stats.reset();
+
+                if (shm) {
+                    shm->heartbeat(market::realtime_ns());
+                }
+                clock.recalibrate();
+                interval_cycles = clock.cycles_for_ns(1'000'000'000ULL);
+            }
+        };
+
+        if (replay) {
+            market::ReplayPacer pacer(cfg.replay_speed);
+            market::ReplayRecord record;
+            const uint64_t replay_start = market::now_ns();
+            uint64_t datagrams = 0;
+
+            while (running.load(std::memory_order_acquire) && replay->next(record)) {
+                pacer.wait(record.recv_ns);
+                const uint64_t now_cycles = market::rdtsc();
+                handle_packet(record.data, record.len, now_cycles, 0, now_cycles);
+                report_interval(now_cycles);
+                ++datagrams;
+            }
+            expire_held();
+            poll_recovery();
+
+            const double elapsed_s = static_cast<double>(market::now_ns() - replay_start) / 1e9;
+            std::cout << "\nReplay finished: " << datagrams << " datagrams, " << replay_messages << " messages in "
+                      << elapsed_s << "s (" << (elapsed_s > 0.0 ? static_cast<double>(replay_messages) / elapsed_s : 0.0)
+                      << " msg/sec)\n";
+            if (replay->truncated() != 0) {
+                std::cout << "  Truncated journal files: " << replay->truncated() << "\n";
             }
+            running.store(false, std::memory_order_release);
+            return;
+        }
+
+        if (byte_ring) {
+            while (running.load(std::memory_order_acquire) || byte_ring->size() > 0) {
+
+                market::ByteRecord record;
+                if (!byte_ring->peek(record)) {
+                    expire_held();
+                    waiter.idle([&]() { return byte_ring->size() > 0; });
+                    continue;
+                }
+                waiter.reset();
+
+                const uint64_t now_cycles = market::rdtsc();
+                handle_packet(record.data, record.len, record.recv_cycles, record.kernel_ns, now_cycles);
+                byte_ring->release();
+                report_interval(now_cycles);
+            }
+            return;
+        }
+
+        while (running.load(std::memory_order_acquire) || slot_ring->size() > 0) {
+
+            const market::RawMessage* raw = slot_ring->peek();
+            if (!raw) {
+                expire_held();
+                waiter.idle([&]() { return slot_ring->size() > 0; });
+                continue;
+            }
+            waiter.reset();
+
+            const uint64_t now_cycles = market::rdtsc();
+            handle_packet(raw->payload.data(), raw->len, raw->recv_cycles, raw->kernel_ns, now_cycles);
+            slot_ring->release();
+            report_interval(now_cycles);
         }
     });
 
+    std::cout << "Processor thread: " << processor_placed.get_future().get() << "\n\n";
+
     const auto start_time = std::chrono::steady_clock::now();
 
     while (running.load(std::memory_order_acquire)) {
@@ -228,12 +808,29 @@ int main(int argc, char** argv) {
         processor.join();
     }
 
-    receiver.stop();
+    for (const auto& shard : shards) {
+        shard->stop();
+    }
+
+    if (receiver) {
+        receiver->stop();
+    }
+    if (capture) {
+        capture->stop();
+    }
 
     std::cout << "\nFinal stats:\n";
-    std::cout << "  Received:  " << receiver.messages_received() << " messages ("
-              << receiver.bytes_received() << " bytes)\n";
-    std::cout << "  Ring push failures: " << receiver.ring_push_failures() << "\n";
+    if (receiver) {
+        std::cout << "  Received:  " << receiver->messages_received() << " datagrams ("
+                  << receiver->bytes_received() << " bytes)\n";
+        std::cout << "  Ring push failures: " << receiver->ring_push_failures() << "\n";
+        if (receiver->line_count() > 1) {
+            print_line_stats(*receiver);
+        }
+    }
+    if (capture) {
+        print_capture_stats(*capture);
+    }
 
     return 0;
 }
@@ -11,8 +11,15 @@ enum MessageType : uint16_t {
     MSG_TRADE = 2,
     MSG_ORDER_ADD = 3,
     MSG_ORDER_CANCEL = 4,
+    MSG_BOOK_RESET = 5,
+    MSG_LEVEL_SET = 6,
+    MSG_ORDER_EXECUTE = 7,
+    MSG_ORDER_MODIFY = 8,
+    MSG_ORDER_REPLACE = 9,
 };
 
+constexpr uint32_t kAllSymbols = 0xFFFFFFFFu;
+
 #pragma pack(push, 1)
 
 struct MessageHeader {
@@ -56,6 +63,43 @@ struct OrderCancel {
     uint32_t symbol_id;
 };
 
+struct OrderExecute {
+    MessageHeader header;
+    uint64_t order_id;
+    uint32_t symbol_id;
+    uint32_t executed_size;
+};
+
+struct OrderModify {
+    MessageHeader header;
+    uint64_t order_id;
+    uint32_t symbol_id;
+    uint32_t size;
+};
+
+struct OrderReplace {
+    MessageHeader header;
+    uint64_t order_id;
+    uint64_t new_order_id;
+    uint32_t symbol_id;
+    int64_t price;
+    uint32_t size;
+};
+
+struct BookReset {
+    MessageHeader header;
+    uint32_t symbol_id;
+};
+
+struct LevelSet {
+    MessageHeader header;
+    uint32_t symbol_id;
+    int64_t price;
+    uint32_t size;
+    char side;
+    char padding[3];
+};
+
 #pragma pack(pop)
 
 struct RawMessage {
@@ -64,7 +108,8 @@ struct RawMessage {
 
     std::array<char, MaxPayload> payload{};
     size_t len{0};
-    uint64_t recv_timestamp_ns{0};
+    uint64_t recv_cycles{0};
+    uint64_t kernel_ns{0};
 };
 
 }
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "market_data.h"
+
+#include <tuple>
+
+namespace market {
+
+template <typename Handler>
+inline void dispatch(const MessageHeader* header, Handler& handler) {
+    handler.on_header(*header);
+    switch (header->msg_type) {
+        case MSG_QUOTE:
+            handler.on_quote(*reinterpret_cast<const Quote*>(header));
+            break;
+        case MSG_TRADE:
+            handler.on_trade(*reinterpret_cast<const Trade*>(header));
+            break;
+        case MSG_ORDER_ADD:
+            handler.on_order_add(*reinterpret_cast<const OrderAdd*>(header));
+            break;
+        case MSG_ORDER_CANCEL:
+            handler.on_order_cancel(*reinterpret_cast<const OrderCancel*>(header));
+            break;
+        case MSG_BOOK_RESET:
+            handler.on_book_reset(*reinterpret_cast<const BookReset*>(header));
+            break;
+        case MSG_LEVEL_SET:
+            handler.on_level_set(*reinterpret_cast<const LevelSet*>(header));
+            break;
+        case MSG_ORDER_EXECUTE:
+            handler.on_order_execute(*reinterpret_cast<const OrderExecute*>(header));
+            break;
+        case MSG_ORDER_MODIFY:
+            handler.on_order_modify(*reinterpret_cast<const OrderModify*>(header));
+            break;
+        case MSG_ORDER_REPLACE:
+            handler.on_order_replace(*reinterpret_cast<const OrderReplace*>(header));
+            break;
+        default:
+            break;
+    }
+}
+
+template <typename Derived>
+class MessageHandler {
+public:
+
+    void on_message(const MessageHeader* header) {
+        dispatch(header, static_cast<Derived&>(*this));
+    }
+
+    void operator()(const MessageHeader* header) {
+        on_message(header);
+    }
+
+    void on_header(const MessageHeader&) {}
+
+    void on_quote(const Quote&) {}
+
+    void on_trade(const Trade&) {}
+
+    void on_order_add(const OrderAdd&) {}
+
+    void on_order_cancel(const OrderCancel&) {}
+
+    void on_order_execute(const OrderExecute&) {}
+
+    void on_order_modify(const OrderModify&) {}
+
+    void on_order_replace(const OrderReplace&) {}
+
+    void on_book_reset(const BookReset&) {}
+
+    void on_level_set(const LevelSet&) {}
+
+protected:
+
+    MessageHandler() = default;
+};
+
+template <typename... Handlers>
+class HandlerChain : public MessageHandler<HandlerChain<Handlers...>> {
+public:
+
+    explicit HandlerChain(Handlers&... handlers)
+        : handlers_(handlers...) {}
+
+    void on_header(const MessageHeader& header) {
+        each([&](auto& handler) { handler.on_header(header); });
+    }
+
+    void on_quote(const Quote& msg) {
+        each([&](auto& handler) { handler.on_quote(msg); });
+    }
+
+    void on_trade(const Trade& msg) {
+        each([&](auto& handler) { handler.on_trade(msg); });
+    }
+
+    void on_order_add(const OrderAdd& msg) {
+        each([&](auto& handler) { handler.on_order_add(msg); });
+    }
+
+    void on_order_cancel(const OrderCancel& msg) {
+        each([&](auto& handler) { handler.on_order_cancel(msg); });
+    }
+
+    void on_order_execute(const OrderExecute& msg) {
+        each([&](auto& handler) { handler.on_order_execute(msg); });
+    }
+
+    void on_order_modify(const OrderModify& msg) {
+        each([&](auto& handler) { handler.on_order_modify(msg); });
+    }
+
+    void on_order_replace(const OrderReplace& msg) {
+        each([&](auto& handler) { handler.on_order_replace(msg); });
+    }
+
+    void on_book_reset(const BookReset& msg) {
+        each([&](auto& handler) { handler.on_book_reset(msg); });
+    }
+
+    void on_level_set(const LevelSet& msg) {
+        each([&](auto& handler) { handler.on_level_set(msg); });
+    }
+
+private:
+
+    template <typename Fn>
+    void each(Fn&& fn) {
+        std::apply([&](auto&... handler) { (fn(handler), ...); }, handlers_);
+    }
+
+    std::tuple<Handlers&...> handlers_;
+};
+
+}
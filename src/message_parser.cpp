@@ -5,52 +5,52 @@
 
 namespace market {
 
+MessageParser::MessageParser(const ReorderConfig& reorder)
+    : reorder_(reorder) {
+
+    if (reorder_.window == 0) {
+        return;
+    }
+
+    uint32_t slots = 1;
+    while (slots < reorder_.window && slots < (1u << 20)) {
+        slots <<= 1;
+    }
+    held_.resize(slots);
+    held_mask_ = slots - 1;
+}
+
 const MessageHeader* MessageParser::parse(const RawMessage& raw) {
+    return parse(raw.payload.data(), raw.len);
+}
 
-    if (raw.len < sizeof(MessageHeader)) {
+const MessageHeader* MessageParser::parse(const char* data, size_t len) {
+
+    if (len < sizeof(MessageHeader)) {
         ++invalid_;
         return nullptr;
     }
 
-    const auto* header = reinterpret_cast<const MessageHeader*>(raw.payload.data());
+    const auto* header = reinterpret_cast<const MessageHeader*>(data);
 
-    if (header->msg_len == 0 || static_cast<size_t>(header->msg_len) > raw.len) {
+    if (header->msg_len == 0 || static_cast<size_t>(header->msg_len) > len) {
         ++invalid_;
         return nullptr;
     }
 
-    const uint64_t expected_len = compute_expected_len(header);
-    if (expected_len == 0 || expected_len != header->msg_len) {
+    const size_t expected = expected_len(header->msg_type);
+    if (expected == 0 || expected != header->msg_len) {
         ++invalid_;
         return nullptr;
     }
 
-    if (last_sequence_ != 0 && header->sequence_num != last_sequence_ + 1) {
-
-        gaps_ += header->sequence_num - last_sequence_ - 1;
-
+    if (!track_sequence(header->sequence_num)) {
+        return nullptr;
     }
-    last_sequence_ = header->sequence_num;
 
     return header;
 }
 
-uint64_t MessageParser::compute_expected_len(const MessageHeader* header) const {
-
-    switch (header->msg_type) {
-        case MSG_QUOTE:
-            return sizeof(Quote);
-        case MSG_TRADE:
-            return sizeof(Trade);
-        case MSG_ORDER_ADD:
-            return sizeof(OrderAdd);
-        case MSG_ORDER_CANCEL:
-            return sizeof(OrderCancel);
-        default:
-            return 0;
-    }
-}
-
 uint64_t MessageParser::sequence_gaps() const {
     return gaps_;
 }
@@ -59,4 +59,33 @@ uint64_t MessageParser::invalid_messages() const {
     return invalid_;
 }
 
+uint64_t MessageParser::packets() const {
+    return packets_;
+}
+
+uint64_t MessageParser::duplicate_messages() const {
+    return duplicates_;
+}
+
+uint64_t MessageParser::reordered_messages() const {
+    return reordered_;
+}
+
+uint64_t MessageParser::gap_timeouts() const {
+    return timeouts_;
+}
+
+uint32_t MessageParser::held_messages() const {
+    return held_count_;
+}
+
+void MessageParser::reset_counters() {
+    gaps_ = 0;
+    invalid_ = 0;
+    packets_ = 0;
+    duplicates_ = 0;
+    reordered_ = 0;
+    timeouts_ = 0;
+}
+
 }
@@ -1,16 +1,98 @@
 #pragma once
 
 #include "market_data.h"
+#include "utils/timestamp.h"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
 
 namespace market {
 
+struct ReorderConfig {
+    uint32_t window{0};
+    uint32_t timeout_messages{1024};
+    uint64_t timeout_ns{500'000};
+};
+
 class MessageParser {
 public:
 
+    static constexpr size_t MaxMessageLen =
+        std::max({sizeof(Quote), sizeof(Trade), sizeof(OrderAdd), sizeof(OrderCancel), sizeof(BookReset),
+                  sizeof(LevelSet), sizeof(OrderExecute), sizeof(OrderModify), sizeof(OrderReplace)});
+
+    MessageParser() = default;
+
+    explicit MessageParser(const ReorderConfig& reorder);
+
     const MessageHeader* parse(const RawMessage& raw);
 
+    const MessageHeader* parse(const char* data, size_t len);
+
+    template <typename Handler>
+    size_t parse_packet(const char* data, size_t len, Handler&& handler) {
+        size_t offset = 0;
+        size_t delivered = 0;
+        ++packets_;
+
+        while (len - offset >= sizeof(MessageHeader)) {
+            const auto* header = reinterpret_cast<const MessageHeader*>(data + offset);
+            const size_t msg_len = header->msg_len;
+
+            if (msg_len < sizeof(MessageHeader) || msg_len > len - offset) {
+                ++invalid_;
+                return delivered;
+            }
+            offset += msg_len;
+
+            if (expected_len(header->msg_type) != msg_len) {
+                ++invalid_;
+                continue;
+            }
+
+            delivered += deliver_in_order(header, handler);
+        }
+
+        if (offset != len) {
+            ++invalid_;
+        }
+        if (held_count_ != 0) {
+            delivered += expire(handler);
+        }
+        return delivered;
+    }
+
+    template <typename Handler>
+    size_t expire(Handler&& handler) {
+        if (held_count_ == 0) {
+            return 0;
+        }
+        if (gap_messages_ < reorder_.timeout_messages && now_ns() - gap_since_ns_ < reorder_.timeout_ns) {
+            return 0;
+        }
+
+        uint32_t first_held = next_sequence_;
+        while (!held_at(first_held)) {
+            ++first_held;
+        }
+        const size_t delivered = skip_to(first_held, handler);
+        ++timeouts_;
+        if (held_count_ != 0) {
+            open_gap();
+        }
+        return delivered;
+    }
+
+    template <typename Handler>
+    size_t parse_packet(const RawMessage& raw, Handler&& handler) {
+        return parse_packet(raw.payload.data(), raw.len, std::forward<Handler>(handler));
+    }
+
     template <typename T>
     const T* as(const MessageHeader* header) const {
 
@@ -21,15 +103,218 @@ public:
 
     uint64_t invalid_messages() const;
 
+    uint64_t packets() const;
+
+    uint64_t duplicate_messages() const;
+
+    uint64_t reordered_messages() const;
+
+    uint64_t gap_timeouts() const;
+
+    uint32_t held_messages() const;
+
+    void reset_counters();
+
+    static size_t expected_len(uint16_t msg_type) {
+        switch (msg_type) {
+            case MSG_QUOTE:
+                return sizeof(Quote);
+            case MSG_TRADE:
+                return sizeof(Trade);
+            case MSG_ORDER_ADD:
+                return sizeof(OrderAdd);
+            case MSG_ORDER_CANCEL:
+                return sizeof(OrderCancel);
+            case MSG_BOOK_RESET:
+                return sizeof(BookReset);
+            case MSG_LEVEL_SET:
+                return sizeof(LevelSet);
+            case MSG_ORDER_EXECUTE:
+                return sizeof(OrderExecute);
+            case MSG_ORDER_MODIFY:
+                return sizeof(OrderModify);
+            case MSG_ORDER_REPLACE:
+                return sizeof(OrderReplace);
+            default:
+                return 0;
+        }
+    }
+
+    static uint32_t symbol_of(const MessageHeader* header) {
+        switch (header->msg_type) {
+            case MSG_QUOTE:
+                return reinterpret_cast<const Quote*>(header)->symbol_id;
+            case MSG_TRADE:
+                return reinterpret_cast<const Trade*>(header)->symbol_id;
+            case MSG_ORDER_ADD:
+                return reinterpret_cast<const OrderAdd*>(header)->symbol_id;
+            case MSG_ORDER_CANCEL:
+                return reinterpret_cast<const OrderCancel*>(header)->symbol_id;
+            case MSG_BOOK_RESET:
+                return reinterpret_cast<const BookReset*>(header)->symbol_id;
+            case MSG_LEVEL_SET:
+                return reinterpret_cast<const LevelSet*>(header)->symbol_id;
+            case MSG_ORDER_EXECUTE:
+                return reinterpret_cast<const OrderExecute*>(header)->symbol_id;
+            case MSG_ORDER_MODIFY:
+                return reinterpret_cast<const OrderModify*>(header)->symbol_id;
+            case MSG_ORDER_REPLACE:
+                return reinterpret_cast<const OrderReplace*>(header)->symbol_id;
+            default:
+                return 0;
+        }
+    }
+
 private:
 
-    uint64_t compute_expected_len(const MessageHeader* header) const;
+    struct HeldMessage {
+        uint32_t sequence{0};
+        bool occupied{false};
+        std::array<char, MaxMessageLen> bytes{};
+    };
+
+    static constexpr int32_t kResyncDistance = 1 << 20;
+
+    bool track_sequence(uint32_t sequence) {
+        if (!started_) {
+            started_ = true;
+            next_sequence_ = sequence;
+        }
+
+        const int32_t ahead = static_cast<int32_t>(sequence - next_sequence_);
+        if (ahead < 0 && ahead > -kResyncDistance) {
+            ++duplicates_;
+            return false;
+        }
+        if (ahead > 0) {
+            gaps_ += static_cast<uint64_t>(ahead);
+        }
+        next_sequence_ = sequence + 1;
+        return true;
+    }
+
+    template <typename Handler>
+    size_t deliver_in_order(const MessageHeader* header, Handler& handler) {
+        if (held_.empty()) {
+            if (!track_sequence(header->sequence_num)) {
+                return 0;
+            }
+            handler(header);
+            return 1;
+        }
+
+        const uint32_t sequence = header->sequence_num;
+        if (!started_) {
+            started_ = true;
+            next_sequence_ = sequence;
+        }
+        if (held_count_ != 0) {
+            ++gap_messages_;
+        }
+
+        const int32_t ahead = static_cast<int32_t>(sequence - next_sequence_);
+        if (ahead == 0) {
+            handler(header);
+            ++next_sequence_;
+            return 1 + release_ready(handler);
+        }
+
+        if (ahead < 0) {
+            if (ahead > -kResyncDistance) {
+                ++duplicates_;
+                return 0;
+            }
+            drop_held();
+            next_sequence_ = sequence + 1;
+            handler(header);
+            return 1;
+        }
+
+        if (static_cast<uint32_t>(ahead) >= held_.size()) {
+            const size_t delivered = skip_to(sequence - static_cast<uint32_t>(held_.size()) + 1, handler);
+            return delivered + deliver_in_order(header, handler);
+        }
+
+        HeldMessage& slot = held_[sequence & held_mask_];
+        if (slot.occupied) {
+            ++duplicates_;
+            return 0;
+        }
+        std::memcpy(slot.bytes.data(), header, header->msg_len);
+        slot.sequence = sequence;
+        slot.occupied = true;
+        if (held_count_++ == 0) {
+            open_gap();
+        }
+        return 0;
+    }
+
+    bool held_at(uint32_t sequence) const {
+        const HeldMessage& slot = held_[sequence & held_mask_];
+        return slot.occupied && slot.sequence == sequence;
+    }
+
+    template <typename Handler>
+    size_t release_ready(Handler& handler) {
+        size_t delivered = 0;
+        while (held_count_ != 0 && held_at(next_sequence_)) {
+            HeldMessage& slot = held_[next_sequence_ & held_mask_];
+            handler(reinterpret_cast<const MessageHeader*>(slot.bytes.data()));
+            slot.occupied = false;
+            --held_count_;
+            ++reordered_;
+            ++next_sequence_;
+            ++delivered;
+        }
+        return delivered;
+    }
+
+    template <typename Handler>
+    size_t skip_to(uint32_t target, Handler& handler) {
+        size_t delivered = 0;
+        while (held_count_ != 0 && static_cast<int32_t>(target - next_sequence_) > 0) {
+            if (held_at(next_sequence_)) {
+                delivered += release_ready(handler);
+                continue;
+            }
+            ++gaps_;
+            ++next_sequence_;
+        }
+        const int32_t remaining = static_cast<int32_t>(target - next_sequence_);
+        if (remaining > 0) {
+            gaps_ += static_cast<uint64_t>(remaining);
+            next_sequence_ = target;
+        }
+        return delivered + release_ready(handler);
+    }
+
+    void open_gap() {
+        gap_messages_ = 0;
+        gap_since_ns_ = now_ns();
+    }
+
+    void drop_held() {
+        for (HeldMessage& slot : held_) {
+            slot.occupied = false;
+        }
+        held_count_ = 0;
+    }
+
+    ReorderConfig reorder_;
+    std::vector<HeldMessage> held_;
+    uint32_t held_mask_{0};
+    uint32_t held_count_{0};
+    uint32_t next_sequence_{0};
+    bool started_{false};
+    uint64_t gap_messages_{0};
+    uint64_t gap_since_ns_{0};
 
-    uint32_t last_sequence_{0};
     uint64_t gaps_{0};
     uint64_t invalid_{0};
+    uint64_t packets_{0};
+    uint64_t duplicates_{0};
+    uint64_t reordered_{0};
+    uint64_t timeouts_{0};
 };
 
 }
-
-}
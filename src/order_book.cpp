@@ -3,81 +3,131 @@
 
 namespace market {
 
-void OrderBook::on_order_add(const OrderAdd& msg) {
+template <typename LevelStore, typename OrderIndex>
+OrderBook<LevelStore, OrderIndex>::OrderBook(const BookConfig& config)
+    : levels_(config), orders_(config) {}
 
-    Order order{msg.order_id, msg.symbol_id, msg.price, msg.size, msg.side};
+template <typename LevelStore, typename OrderIndex>
+void OrderBook<LevelStore, OrderIndex>::on_order_add(const OrderAdd& msg) {
 
-    orders_[msg.order_id] = order;
+    const Order order{msg.order_id, msg.symbol_id, msg.price, msg.size, msg.side};
 
-    if (msg.side == 'B') {
+    if (!orders_.insert(order)) {
+        ++rejected_;
+        return;
+    }
+
+    levels_.add(msg.side, msg.price, msg.size);
+}
+
+template <typename LevelStore, typename OrderIndex>
+void OrderBook<LevelStore, OrderIndex>::on_order_cancel(const OrderCancel& msg) {
 
-        bids_[msg.price] += msg.size;
-    } else {
+    const Order* order = orders_.find(msg.order_id);
+    if (order == nullptr) {
 
-        asks_[msg.price] += msg.size;
+        return;
     }
+
+    levels_.reduce(order->side, order->price, order->size);
+
+    orders_.erase(msg.order_id);
 }
 
-void OrderBook::on_order_cancel(const OrderCancel& msg) {
+template <typename LevelStore, typename OrderIndex>
+void OrderBook<LevelStore, OrderIndex>::on_order_execute(const OrderExecute& msg) {
 
-    const auto it = orders_.find(msg.order_id);
-    if (it == orders_.end()) {
+    Order* order = orders_.find(msg.order_id);
+    if (order == nullptr) {
 
         return;
     }
 
-    const auto& order = it->second;
-
-    if (order.side == 'B') {
+    reduce_order(*order, msg.executed_size);
+}
 
-        auto book_it = bids_.find(order.price);
-        if (book_it != bids_.end()) {
-            if (book_it->second > order.size) {
+template <typename LevelStore, typename OrderIndex>
+void OrderBook<LevelStore, OrderIndex>::on_order_modify(const OrderModify& msg) {
 
-                book_it->second -= order.size;
-            } else {
+    Order* order = orders_.find(msg.order_id);
+    if (order == nullptr) {
 
-                bids_.erase(book_it);
-            }
-        }
-    } else {
+        return;
+    }
 
-        auto book_it = asks_.find(order.price);
-        if (book_it != asks_.end()) {
-            if (book_it->second > order.size) {
-                book_it->second -= order.size;
-            } else {
-                asks_.erase(book_it);
-            }
-        }
+    if (msg.size > order->size) {
+        ++rejected_;
+        return;
     }
 
-    orders_.erase(it);
+    reduce_order(*order, order->size - msg.size);
 }
 
-void OrderBook::on_quote(const Quote& msg) {
+template <typename LevelStore, typename OrderIndex>
+void OrderBook<LevelStore, OrderIndex>::on_order_replace(const OrderReplace& msg) {
 
-    bids_[msg.bid_price] = msg.bid_size;
-    asks_[msg.ask_price] = msg.ask_size;
-}
+    const Order* order = orders_.find(msg.order_id);
+    if (order == nullptr) {
 
-int64_t OrderBook::best_bid() const {
-    if (bids_.empty()) {
-        return 0;
+        return;
     }
 
-    return bids_.begin()->first;
+    const Order replacement{msg.new_order_id, order->symbol_id, msg.price, msg.size, order->side};
+    levels_.reduce(order->side, order->price, order->size);
+    orders_.erase(msg.order_id);
+
+    if (!orders_.insert(replacement)) {
+        ++rejected_;
+        return;
+    }
+
+    levels_.add(replacement.side, replacement.price, replacement.size);
 }
 
-int64_t OrderBook::best_ask() const {
-    if (asks_.empty()) {
-        return 0;
+template <typename LevelStore, typename OrderIndex>
+void OrderBook<LevelStore, OrderIndex>::reduce_order(Order& order, uint32_t size) {
+
+    if (size >= order.size) {
+        levels_.reduce(order.side, order.price, order.size);
+        orders_.erase(order.order_id);
+        return;
     }
 
-    return asks_.begin()->first;
+    levels_.reduce(order.side, order.price, size);
+    order.size -= size;
+}
+
+template <typename LevelStore, typename OrderIndex>
+void OrderBook<LevelStore, OrderIndex>::on_quote(const Quote& msg) {
+
+    levels_.set('B', msg.bid_price, msg.bid_size);
+    levels_.set('S', msg.ask_price, msg.ask_size);
+}
+
+template <typename LevelStore, typename OrderIndex>
+void OrderBook<LevelStore, OrderIndex>::on_level_set(const LevelSet& msg) {
+
+    levels_.set(msg.side, msg.price, msg.size);
+}
+
+template <typename LevelStore, typename OrderIndex>
+void OrderBook<LevelStore, OrderIndex>::reset() {
+    levels_.reset();
+    orders_.clear();
+}
+
+template <typename LevelStore, typename OrderIndex>
+int64_t OrderBook<LevelStore, OrderIndex>::best_bid() const {
+    return levels_.best_bid();
 }
 
-int64_t OrderBook::spread() const {
+template <typename LevelStore, typename OrderIndex>
+int64_t OrderBook<LevelStore, OrderIndex>::best_ask() const {
+    return levels_.best_ask();
+}
+
+template <typename LevelStore, typename OrderIndex>
+int64_t OrderBook<LevelStore, OrderIndex>::spread() const {
     const auto bid = best_bid();
     const auto ask = best_ask();
 
@@ -88,26 +138,36 @@ int64_t OrderBook::spread() const {
     return ask - bid;
 }
 
-void OrderBook::print_top_levels(int n) const {
-    std::cout << "Top " << n << " Bids:\n";
-    int count = 0;
+template <typename LevelStore, typename OrderIndex>
+BookTop OrderBook<LevelStore, OrderIndex>::top() const {
+    BookTop top;
+    levels_.for_each_level('B', 1, [&](int64_t price, uint32_t size) {
+        top.bid_price = price;
+        top.bid_size = size;
+    });
+    levels_.for_each_level('S', 1, [&](int64_t price, uint32_t size) {
+        top.ask_price = price;
+        top.ask_size = size;
+    });
+    return top;
+}
 
-    for (const auto& [price, size] : bids_) {
-        if (count++ >= n) {
-            break;
-        }
+template <typename LevelStore, typename OrderIndex>
+void OrderBook<LevelStore, OrderIndex>::print_top_levels(int n) const {
+    auto print = [](int64_t price, uint32_t size) {
         std::cout << "  " << price << " : " << size << "\n";
-    }
+    };
 
-    std::cout << "Top " << n << " Asks:\n";
-    count = 0;
+    std::cout << "Top " << n << " Bids:\n";
+    levels_.for_each_level('B', n, print);
 
-    for (const auto& [price, size] : asks_) {
-        if (count++ >= n) {
-            break;
-        }
-        std::cout << "  " << price << " : " << size << "\n";
-    }
+    std::cout << "Top " << n << " Asks:\n";
+    levels_.for_each_level('S', n, print);
 }
 
+template class OrderBook<MapLevels, StdOrderIndex>;
+template class OrderBook<TickLadder, StdOrderIndex>;
+template class OrderBook<MapLevels, FlatOrderIndex>;
+template class OrderBook<TickLadder, FlatOrderIndex>;
+
 }
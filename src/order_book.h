@@ -1,48 +1,91 @@
 #pragma once
 
 #include "market_data.h"
+#include "order_index.h"
+#include "price_levels.h"
 
 #include <cstdint>
 #include <iostream>
-#include <map>
-#include <unordered_map>
 
 namespace market {
 
-struct Order {
-    uint64_t order_id{};
-    uint32_t symbol_id{};
-    int64_t price{};
-    uint32_t size{};
-    char side{0};
+struct BookTop {
+    int64_t bid_price{0};
+    int64_t ask_price{0};
+    uint32_t bid_size{0};
+    uint32_t ask_size{0};
+
+    bool operator==(const BookTop& other) const {
+        return bid_price == other.bid_price && ask_price == other.ask_price && bid_size == other.bid_size &&
+               ask_size == other.ask_size;
+    }
+
+    bool operator!=(const BookTop& other) const {
+        return !(*this == other);
+    }
 };
 
+template <typename LevelStore = MapLevels, typename OrderIndex = StdOrderIndex>
 class OrderBook {
 public:
 
+    using Levels = LevelStore;
+    using Orders = OrderIndex;
+
+    explicit OrderBook(const BookConfig& config = BookConfig{});
+
     void on_order_add(const OrderAdd& msg);
 
     void on_order_cancel(const OrderCancel& msg);
 
+    void on_order_execute(const OrderExecute& msg);
+
+    void on_order_modify(const OrderModify& msg);
+
+    void on_order_replace(const OrderReplace& msg);
+
     void on_quote(const Quote& msg);
 
+    void on_level_set(const LevelSet& msg);
+
+    void reset();
+
     int64_t best_bid() const;
 
     int64_t best_ask() const;
 
     int64_t spread() const;
 
+    BookTop top() const;
+
     void print_top_levels(int n = 5) const;
 
+    const LevelStore& levels() const {
+        return levels_;
+    }
+
+    const OrderIndex& orders() const {
+        return orders_;
+    }
+
+    uint64_t rejected_orders() const {
+        return rejected_;
+    }
+
 private:
 
-    std::map<int64_t, uint32_t, std::greater<>> bids_;
+    void reduce_order(Order& order, uint32_t size);
+
+    LevelStore levels_;
 
-    std::map<int64_t, uint32_t> asks_;
+    OrderIndex orders_;
 
-    std::unordered_map<uint64_t, Order> orders_;
+    uint64_t rejected_{0};
 };
 
-}
+extern template class OrderBook<MapLevels, StdOrderIndex>;
+extern template class OrderBook<TickLadder, StdOrderIndex>;
+extern template class OrderBook<MapLevels, FlatOrderIndex>;
+extern template class OrderBook<TickLadder, FlatOrderIndex>;
 
 }
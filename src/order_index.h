@@ -0,0 +1,222 @@
+#pragma once
+
+#include "book_config.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace market {
+
+struct Order {
+    uint64_t order_id{};
+    uint32_t symbol_id{};
+    int64_t price{};
+    uint32_t size{};
+    char side{0};
+};
+
+class StdOrderIndex {
+public:
+
+    explicit StdOrderIndex(const BookConfig& config = BookConfig{}) {
+        orders_.reserve(config.order_capacity);
+    }
+
+    bool insert(const Order& order) {
+        orders_[order.order_id] = order;
+        return true;
+    }
+
+    Order* find(uint64_t order_id) {
+        const auto it = orders_.find(order_id);
+        return it == orders_.end() ? nullptr : &it->second;
+    }
+
+    const Order* find(uint64_t order_id) const {
+        const auto it = orders_.find(order_id);
+        return it == orders_.end() ? nullptr : &it->second;
+    }
+
+    bool erase(uint64_t order_id) {
+        return orders_.erase(order_id) != 0;
+    }
+
+    void clear() {
+        orders_.clear();
+    }
+
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const auto& [order_id, order] : orders_) {
+            fn(order);
+        }
+    }
+
+    size_t size() const {
+        return orders_.size();
+    }
+
+private:
+
+    std::unordered_map<uint64_t, Order> orders_;
+};
+
+class FlatOrderIndex {
+public:
+
+    static constexpr uint8_t kMaxProbe = 128;
+
+    explicit FlatOrderIndex(const BookConfig& config = BookConfig{})
+        : FlatOrderIndex(config.order_capacity) {}
+
+    explicit FlatOrderIndex(size_t capacity)
+        : max_size_(capacity > 0 ? capacity : 1) {
+
+        size_t slots = 16;
+        while (slots - slots / 8 < max_size_) {
+            slots <<= 1;
+        }
+
+        mask_ = slots - 1;
+        shift_ = 64;
+        for (size_t bits = slots; bits > 1; bits >>= 1) {
+            --shift_;
+        }
+
+        slots_.resize(slots);
+        probe_.assign(slots, 0);
+    }
+
+    bool insert(const Order& order) {
+        size_t idx = home(order.order_id);
+        uint8_t dist = 1;
+
+        while (probe_[idx] >= dist) {
+            if (probe_[idx] == dist && slots_[idx].order_id == order.order_id) {
+                slots_[idx] = order;
+                return true;
+            }
+
+            if (++dist > kMaxProbe) {
+                return false;
+            }
+            idx = (idx + 1) & mask_;
+        }
+
+        if (size_ == max_size_) {
+            return false;
+        }
+
+        size_t empty = idx;
+        while (probe_[empty] != 0) {
+            if (probe_[empty] == kMaxProbe) {
+                return false;
+            }
+            empty = (empty + 1) & mask_;
+        }
+
+        while (empty != idx) {
+            const size_t prev = (empty - 1) & mask_;
+            slots_[empty] = slots_[prev];
+            probe_[empty] = static_cast<uint8_t>(probe_[prev] + 1);
+            empty = prev;
+        }
+
+        slots_[idx] = order;
+        probe_[idx] = dist;
+        ++size_;
+        if (dist > longest_probe_) {
+            longest_probe_ = dist;
+        }
+        return true;
+    }
+
+    Order* find(uint64_t order_id) {
+        size_t idx = home(order_id);
+        uint8_t dist = 1;
+
+        while (probe_[idx] >= dist) {
+            if (probe_[idx] == dist && slots_[idx].order_id == order_id) {
+                return &slots_[idx];
+            }
+            ++dist;
+            idx = (idx + 1) & mask_;
+        }
+        return nullptr;
+    }
+
+    const Order* find(uint64_t order_id) const {
+        return const_cast<FlatOrderIndex*>(this)->find(order_id);
+    }
+
+    bool erase(uint64_t order_id) {
+        Order* order = find(order_id);
+        if (order == nullptr) {
+            return false;
+        }
+
+        size_t idx = static_cast<size_t>(order - slots_.data());
+        size_t next = (idx + 1) & mask_;
+        while (probe_[next] > 1) {
+            slots_[idx] = slots_[next];
+            probe_[idx] = static_cast<uint8_t>(probe_[next] - 1);
+            idx = next;
+            next = (next + 1) & mask_;
+        }
+
+        probe_[idx] = 0;
+        --size_;
+        return true;
+    }
+
+    void clear() {
+        std::fill(probe_.begin(), probe_.end(), 0);
+        size_ = 0;
+        longest_probe_ = 0;
+    }
+
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t idx = 0; idx < slots_.size(); ++idx) {
+            if (probe_[idx] != 0) {
+                fn(slots_[idx]);
+            }
+        }
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    size_t capacity() const {
+        return max_size_;
+    }
+
+    size_t slot_count() const {
+        return slots_.size();
+    }
+
+    uint8_t longest_probe() const {
+        return longest_probe_;
+    }
+
+private:
+
+    size_t home(uint64_t order_id) const {
+
+        return static_cast<size_t>((order_id * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+
+    std::vector<Order> slots_;
+    std::vector<uint8_t> probe_;
+    size_t max_size_;
+    size_t size_{0};
+    size_t mask_{0};
+    uint32_t shift_{64};
+    uint8_t longest_probe_{0};
+};
+
+}
@@ -0,0 +1,433 @@
+#pragma once
+
+#include "book_config.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace market {
+
+class MapLevels {
+public:
+
+    explicit MapLevels(const BookConfig& = BookConfig{}) {}
+
+    void add(char side, int64_t price, uint32_t size) {
+        if (size == 0) {
+            return;
+        }
+
+        if (side == 'B') {
+            bids_[price] += size;
+        } else {
+            asks_[price] += size;
+        }
+    }
+
+    void reduce(char side, int64_t price, uint32_t size) {
+        if (side == 'B') {
+            reduce_level(bids_, price, size);
+        } else {
+            reduce_level(asks_, price, size);
+        }
+    }
+
+    void set(char side, int64_t price, uint32_t size) {
+        if (side == 'B') {
+            set_level(bids_, price, size);
+        } else {
+            set_level(asks_, price, size);
+        }
+    }
+
+    void reset() {
+        bids_.clear();
+        asks_.clear();
+    }
+
+    int64_t best_bid() const {
+        return bids_.empty() ? 0 : bids_.begin()->first;
+    }
+
+    int64_t best_ask() const {
+        return asks_.empty() ? 0 : asks_.begin()->first;
+    }
+
+    template <typename Fn>
+    void for_each_level(char side, int n, Fn&& fn) const {
+        if (side == 'B') {
+            visit(bids_, n, fn);
+        } else {
+            visit(asks_, n, fn);
+        }
+    }
+
+private:
+
+    template <typename Map>
+    static void reduce_level(Map& levels, int64_t price, uint32_t size) {
+        auto it = levels.find(price);
+        if (it == levels.end()) {
+            return;
+        }
+
+        if (it->second > size) {
+            it->second -= size;
+        } else {
+            levels.erase(it);
+        }
+    }
+
+    template <typename Map>
+    static void set_level(Map& levels, int64_t price, uint32_t size) {
+        if (size == 0) {
+            levels.erase(price);
+        } else {
+            levels[price] = size;
+        }
+    }
+
+    template <typename Map, typename Fn>
+    static void visit(const Map& levels, int n, Fn& fn) {
+        int count = 0;
+        for (const auto& [price, size] : levels) {
+            if (count++ >= n) {
+                break;
+            }
+            fn(price, size);
+        }
+    }
+
+    std::map<int64_t, uint32_t, std::greater<>> bids_;
+
+    std::map<int64_t, uint32_t> asks_;
+};
+
+namespace detail {
+
+inline uint32_t count_trailing_zeros(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<uint32_t>(__builtin_ctzll(word));
+#else
+    uint32_t bit = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+template <bool IsBid>
+class LadderSide {
+public:
+
+    explicit LadderSide(const BookConfig& config)
+        : tick_size_(config.tick_size > 0 ? config.tick_size : 1),
+          levels_(round_up(config.ladder_levels), 0),
+          scratch_(levels_.size(), 0),
+          occupied_(levels_.size() / 64, 0),
+          margin_(levels_.size() / 4) {}
+
+    void add(int64_t price, uint32_t size) {
+        if (size == 0) {
+            return;
+        }
+
+        const int64_t ordinal = to_ordinal(price);
+        if (!in_window(ordinal) && !place(ordinal)) {
+            overflow_[ordinal] += size;
+            return;
+        }
+
+        const size_t idx = static_cast<size_t>(ordinal - base_);
+        if (levels_[idx] == 0) {
+            mark(idx);
+        }
+        levels_[idx] += size;
+    }
+
+    void reduce(int64_t price, uint32_t size) {
+        const int64_t ordinal = to_ordinal(price);
+        if (!in_window(ordinal)) {
+            auto it = overflow_.find(ordinal);
+            if (it == overflow_.end()) {
+                return;
+            }
+
+            if (it->second > size) {
+                it->second -= size;
+            } else {
+                overflow_.erase(it);
+            }
+            return;
+        }
+
+        const size_t idx = static_cast<size_t>(ordinal - base_);
+        if (levels_[idx] == 0) {
+            return;
+        }
+
+        if (levels_[idx] > size) {
+            levels_[idx] -= size;
+        } else {
+            clear(idx);
+        }
+    }
+
+    void set(int64_t price, uint32_t size) {
+        const int64_t ordinal = to_ordinal(price);
+        if (size == 0) {
+            if (in_window(ordinal)) {
+                const size_t idx = static_cast<size_t>(ordinal - base_);
+                if (levels_[idx] != 0) {
+                    clear(idx);
+                }
+            } else {
+                overflow_.erase(ordinal);
+            }
+            return;
+        }
+
+        if (!in_window(ordinal) && !place(ordinal)) {
+            overflow_[ordinal] = size;
+            return;
+        }
+
+        const size_t idx = static_cast<size_t>(ordinal - base_);
+        if (levels_[idx] == 0) {
+            mark(idx);
+        }
+        levels_[idx] = size;
+    }
+
+    void reset() {
+        std::fill(levels_.begin(), levels_.end(), 0);
+        std::fill(occupied_.begin(), occupied_.end(), 0);
+        overflow_.clear();
+        best_idx_ = 0;
+        count_ = 0;
+    }
+
+    int64_t best() const {
+        if (count_ == 0) {
+            return 0;
+        }
+        return to_price(base_ + static_cast<int64_t>(best_idx_));
+    }
+
+    template <typename Fn>
+    void for_each_level(int n, Fn& fn) const {
+        int count = 0;
+        for (size_t idx = best_idx_; count_ > 0 && idx < levels_.size() && count < n; ++idx) {
+            if (levels_[idx] != 0) {
+                fn(to_price(base_ + static_cast<int64_t>(idx)), levels_[idx]);
+                ++count;
+            }
+        }
+
+        for (auto it = overflow_.begin(); it != overflow_.end() && count < n; ++it, ++count) {
+            fn(to_price(it->first), it->second);
+        }
+    }
+
+    uint64_t recenters() const {
+        return recenters_;
+    }
+
+private:
+
+    static size_t round_up(uint32_t levels) {
+        size_t size = 64;
+        while (size < levels) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    int64_t to_ordinal(int64_t price) const {
+        const int64_t ticks = price / tick_size_;
+        return IsBid ? -ticks : ticks;
+    }
+
+    int64_t to_price(int64_t ordinal) const {
+        return (IsBid ? -ordinal : ordinal) * tick_size_;
+    }
+
+    bool in_window(int64_t ordinal) const {
+        return ordinal >= base_ && ordinal < base_ + static_cast<int64_t>(levels_.size());
+    }
+
+    void mark(size_t idx) {
+        occupied_[idx >> 6] |= (1ULL << (idx & 63));
+        if (count_ == 0 || idx < best_idx_) {
+            best_idx_ = idx;
+        }
+        ++count_;
+    }
+
+    void clear(size_t idx) {
+        levels_[idx] = 0;
+        occupied_[idx >> 6] &= ~(1ULL << (idx & 63));
+        --count_;
+
+        if (count_ == 0) {
+            best_idx_ = 0;
+            if (!overflow_.empty()) {
+                recenter(overflow_.begin()->first - static_cast<int64_t>(margin_));
+            }
+            return;
+        }
+
+        if (idx == best_idx_) {
+            best_idx_ = next_occupied(idx + 1);
+        }
+    }
+
+    size_t next_occupied(size_t from) const {
+        size_t word = from >> 6;
+        if (word >= occupied_.size()) {
+            return levels_.size();
+        }
+
+        uint64_t bits = occupied_[word] & (~0ULL << (from & 63));
+        while (bits == 0) {
+            if (++word == occupied_.size()) {
+                return levels_.size();
+            }
+            bits = occupied_[word];
+        }
+        return (word << 6) + count_trailing_zeros(bits);
+    }
+
+    bool place(int64_t ordinal) {
+
+        if (count_ == 0 || ordinal < base_) {
+            recenter(ordinal - static_cast<int64_t>(margin_));
+            return true;
+        }
+        return false;
+    }
+
+    void recenter(int64_t new_base) {
+        ++recenters_;
+
+        const int64_t window = static_cast<int64_t>(levels_.size());
+        for (size_t idx = 0; count_ > 0 && idx < levels_.size(); ++idx) {
+            if (levels_[idx] == 0) {
+                continue;
+            }
+
+            const int64_t ordinal = base_ + static_cast<int64_t>(idx);
+            if (ordinal >= new_base + window) {
+                overflow_[ordinal] += levels_[idx];
+                levels_[idx] = 0;
+                --count_;
+            }
+        }
+
+        std::fill(scratch_.begin(), scratch_.end(), 0);
+        for (size_t idx = 0; count_ > 0 && idx < levels_.size(); ++idx) {
+            if (levels_[idx] != 0) {
+                scratch_[static_cast<size_t>(base_ + static_cast<int64_t>(idx) - new_base)] = levels_[idx];
+            }
+        }
+        levels_.swap(scratch_);
+        base_ = new_base;
+
+        while (!overflow_.empty() && overflow_.begin()->first < base_ + window) {
+            levels_[static_cast<size_t>(overflow_.begin()->first - base_)] += overflow_.begin()->second;
+            overflow_.erase(overflow_.begin());
+        }
+
+        std::fill(occupied_.begin(), occupied_.end(), 0);
+        count_ = 0;
+        best_idx_ = 0;
+        for (size_t idx = 0; idx < levels_.size(); ++idx) {
+            if (levels_[idx] != 0) {
+                mark(idx);
+            }
+        }
+    }
+
+    int64_t tick_size_;
+    std::vector<uint32_t> levels_;
+    std::vector<uint32_t> scratch_;
+    std::vector<uint64_t> occupied_;
+    size_t margin_;
+    int64_t base_{0};
+    size_t best_idx_{0};
+    size_t count_{0};
+    uint64_t recenters_{0};
+
+    std::map<int64_t, uint32_t> overflow_;
+};
+
+}
+
+class TickLadder {
+public:
+
+    explicit TickLadder(const BookConfig& config = BookConfig{})
+        : bids_(config), asks_(config) {}
+
+    void add(char side, int64_t price, uint32_t size) {
+        if (side == 'B') {
+            bids_.add(price, size);
+        } else {
+            asks_.add(price, size);
+        }
+    }
+
+    void reduce(char side, int64_t price, uint32_t size) {
+        if (side == 'B') {
+            bids_.reduce(price, size);
+        } else {
+            asks_.reduce(price, size);
+        }
+    }
+
+    void set(char side, int64_t price, uint32_t size) {
+        if (side == 'B') {
+            bids_.set(price, size);
+        } else {
+            asks_.set(price, size);
+        }
+    }
+
+    void reset() {
+        bids_.reset();
+        asks_.reset();
+    }
+
+    int64_t best_bid() const {
+        return bids_.best();
+    }
+
+    int64_t best_ask() const {
+        return asks_.best();
+    }
+
+    template <typename Fn>
+    void for_each_level(char side, int n, Fn&& fn) const {
+        if (side == 'B') {
+            bids_.for_each_level(n, fn);
+        } else {
+            asks_.for_each_level(n, fn);
+        }
+    }
+
+    uint64_t recenters() const {
+        return bids_.recenters() + asks_.recenters();
+    }
+
+private:
+
+    detail::LadderSide<true> bids_;
+    detail::LadderSide<false> asks_;
+};
+
+}
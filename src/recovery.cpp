@@ -0,0 +1,163 @@
+
+#include "recovery.h"
+
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace market {
+
+namespace {
+
+#ifdef _WIN32
+using tcp_handle_t = SOCKET;
+constexpr tcp_handle_t kInvalidTcp = INVALID_SOCKET;
+
+void close_tcp(tcp_handle_t fd) {
+    closesocket(fd);
+}
+#else
+using tcp_handle_t = int;
+constexpr tcp_handle_t kInvalidTcp = -1;
+
+void close_tcp(tcp_handle_t fd) {
+    close(fd);
+}
+#endif
+
+bool read_exact(tcp_handle_t fd, char* data, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        const auto got = recv(fd, data + done, static_cast<int>(len - done), 0);
+        if (got <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(got);
+    }
+    return true;
+}
+
+}
+
+SnapshotClient::SnapshotClient(const RecoveryConfig& config)
+    : config_(config) {
+
+#ifdef _WIN32
+    WSADATA data{};
+    WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+    thread_ = std::thread([this]() { run(); });
+}
+
+SnapshotClient::~SnapshotClient() {
+    running_.store(false, std::memory_order_release);
+    doorbell_.notify();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool SnapshotClient::request() {
+    uint32_t expected = Idle;
+    if (!state_.compare_exchange_strong(expected, Requested, std::memory_order_acq_rel)) {
+        return false;
+    }
+    doorbell_.notify();
+    return true;
+}
+
+void SnapshotClient::release() {
+    state_.store(Idle, std::memory_order_release);
+}
+
+void SnapshotClient::run() {
+    auto wanted = [this]() {
+        return state_.load(std::memory_order_acquire) == Requested || !running_.load(std::memory_order_relaxed);
+    };
+
+    while (running_.load(std::memory_order_acquire)) {
+
+        if (state_.load(std::memory_order_acquire) != Requested) {
+            doorbell_.wait(wanted, std::chrono::milliseconds(100));
+            continue;
+        }
+
+        if (fetch()) {
+            state_.store(Ready, std::memory_order_release);
+            continue;
+        }
+
+        failures_.fetch_add(1, std::memory_order_relaxed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(config_.retry_ms));
+    }
+}
+
+bool SnapshotClient::fetch() {
+
+    const tcp_handle_t fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == kInvalidTcp) {
+        return false;
+    }
+
+#ifdef _WIN32
+    DWORD timeout_ms = 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout_ms), sizeof(timeout_ms));
+#else
+    timeval timeout{};
+    timeout.tv_sec = 1;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+
+    sockaddr_in server{};
+    server.sin_family = AF_INET;
+    server.sin_port = htons(config_.port);
+    if (inet_pton(AF_INET, config_.host.c_str(), &server.sin_addr) != 1 ||
+        connect(fd, reinterpret_cast<const sockaddr*>(&server), sizeof(server)) != 0) {
+        close_tcp(fd);
+        return false;
+    }
+
+    const SnapshotRequest request{kSnapshotMagic, 0};
+    SnapshotHeader header{};
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    bool ok = send(fd, reinterpret_cast<const char*>(&request), sizeof(request), flags) ==
+                  static_cast<int>(sizeof(request)) &&
+              read_exact(fd, reinterpret_cast<char*>(&header), sizeof(header)) && header.magic == kSnapshotMagic;
+    if (ok) {
+        messages_.resize(header.bytes);
+        ok = read_exact(fd, messages_.data(), messages_.size());
+        sequence_ = header.sequence_num;
+    }
+
+    close_tcp(fd);
+    return ok;
+}
+
+RecoveryCoordinator::RecoveryCoordinator(const RecoveryConfig& config)
+    : client_(config), buffer_(config.buffer_messages * MessageParser::MaxMessageLen) {}
+
+}
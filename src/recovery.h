@@ -0,0 +1,262 @@
+#pragma once
+
+#include "market_data.h"
+#include "message_parser.h"
+#include "wait_strategy.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace market {
+
+constexpr uint32_t kSnapshotMagic = 0x50414E53u;
+
+#pragma pack(push, 1)
+
+struct SnapshotRequest {
+    uint32_t magic;
+    uint32_t reserved;
+};
+
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t sequence_num;
+    uint32_t message_count;
+    uint32_t bytes;
+};
+
+#pragma pack(pop)
+
+struct RecoveryConfig {
+    std::string host{"127.0.0.1"};
+    uint16_t port{0};
+    size_t buffer_messages{1u << 18};
+    uint32_t retry_ms{50};
+};
+
+class SnapshotClient {
+public:
+
+    explicit SnapshotClient(const RecoveryConfig& config);
+
+    ~SnapshotClient();
+
+    SnapshotClient(const SnapshotClient&) = delete;
+    SnapshotClient& operator=(const SnapshotClient&) = delete;
+
+    bool request();
+
+    bool ready() const {
+        return state_.load(std::memory_order_acquire) == Ready;
+    }
+
+    uint32_t sequence() const {
+        return sequence_;
+    }
+
+    const std::vector<char>& messages() const {
+        return messages_;
+    }
+
+    void release();
+
+    uint64_t failures() const {
+        return failures_.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    enum State : uint32_t {
+        Idle,
+        Requested,
+        Ready,
+    };
+
+    void run();
+
+    bool fetch();
+
+    RecoveryConfig config_;
+    std::vector<char> messages_;
+    uint32_t sequence_{0};
+    Doorbell doorbell_;
+    std::thread thread_;
+    std::atomic<uint32_t> state_{Idle};
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> failures_{0};
+};
+
+class RecoveryCoordinator {
+public:
+
+    explicit RecoveryCoordinator(const RecoveryConfig& config);
+
+    template <typename Sink>
+    void on_message(const MessageHeader* header, Sink&& sink) {
+        const uint32_t sequence = header->sequence_num;
+        if (!started_) {
+            started_ = true;
+            next_sequence_ = sequence;
+        }
+
+        if (recovering_) {
+            buffer(header);
+            return;
+        }
+
+        const int32_t ahead = static_cast<int32_t>(sequence - next_sequence_);
+        if (ahead < 0) {
+            ++skipped_;
+            return;
+        }
+        if (ahead > 0) {
+            begin_recovery(sink);
+            buffer(header);
+            return;
+        }
+
+        ++next_sequence_;
+        sink(header);
+    }
+
+    template <typename Sink>
+    size_t poll(Sink&& sink) {
+        if (!recovering_ || !client_.ready()) {
+            return 0;
+        }
+
+        const uint32_t snapshot_sequence = client_.sequence();
+        if (buffered_count_ != 0 && static_cast<int32_t>(buffered_first_ - snapshot_sequence) > 1) {
+            ++stale_snapshots_;
+            client_.release();
+            client_.request();
+            return 0;
+        }
+
+        size_t applied = 0;
+        const std::vector<char>& snapshot = client_.messages();
+        for (size_t offset = 0; offset + sizeof(MessageHeader) <= snapshot.size();) {
+            const auto* header = reinterpret_cast<const MessageHeader*>(snapshot.data() + offset);
+            if (header->msg_len < sizeof(MessageHeader) || offset + header->msg_len > snapshot.size()) {
+                break;
+            }
+            sink(header);
+            offset += header->msg_len;
+            ++applied;
+        }
+        client_.release();
+
+        next_sequence_ = snapshot_sequence + 1;
+        for (size_t offset = 0; offset < buffered_bytes_;) {
+            const auto* header = reinterpret_cast<const MessageHeader*>(buffer_.data() + offset);
+            if (static_cast<int32_t>(header->sequence_num - snapshot_sequence) > 0) {
+                sink(header);
+                next_sequence_ = header->sequence_num + 1;
+                ++replayed_;
+                ++applied;
+            }
+            offset += header->msg_len;
+        }
+
+        buffered_bytes_ = 0;
+        buffered_count_ = 0;
+        recovering_ = false;
+        ++snapshots_applied_;
+        return applied;
+    }
+
+    bool recovering() const {
+        return recovering_;
+    }
+
+    uint64_t recoveries() const {
+        return recoveries_;
+    }
+
+    uint64_t snapshots_applied() const {
+        return snapshots_applied_;
+    }
+
+    uint64_t replayed_messages() const {
+        return replayed_;
+    }
+
+    uint64_t stale_snapshots() const {
+        return stale_snapshots_;
+    }
+
+    uint64_t buffer_restarts() const {
+        return buffer_restarts_;
+    }
+
+    uint64_t skipped_messages() const {
+        return skipped_;
+    }
+
+    size_t buffered_messages() const {
+        return buffered_count_;
+    }
+
+    uint64_t snapshot_failures() const {
+        return client_.failures();
+    }
+
+private:
+
+    template <typename Sink>
+    void begin_recovery(Sink& sink) {
+        BookReset reset{};
+        reset.header.msg_type = MSG_BOOK_RESET;
+        reset.header.msg_len = sizeof(reset);
+        reset.header.sequence_num = next_sequence_;
+        reset.symbol_id = kAllSymbols;
+        sink(&reset.header);
+
+        recovering_ = true;
+        ++recoveries_;
+        buffered_bytes_ = 0;
+        buffered_count_ = 0;
+        client_.request();
+    }
+
+    void buffer(const MessageHeader* header) {
+        const bool broken = buffered_count_ != 0 && header->sequence_num != buffered_next_;
+        if (broken || buffered_bytes_ + header->msg_len > buffer_.size()) {
+            ++buffer_restarts_;
+            buffered_bytes_ = 0;
+            buffered_count_ = 0;
+        }
+
+        if (buffered_count_ == 0) {
+            buffered_first_ = header->sequence_num;
+        }
+        std::memcpy(buffer_.data() + buffered_bytes_, header, header->msg_len);
+        buffered_bytes_ += header->msg_len;
+        ++buffered_count_;
+        buffered_next_ = header->sequence_num + 1;
+    }
+
+    SnapshotClient client_;
+    std::vector<char> buffer_;
+    size_t buffered_bytes_{0};
+    size_t buffered_count_{0};
+    uint32_t buffered_first_{0};
+    uint32_t buffered_next_{0};
+    uint32_t next_sequence_{0};
+    bool started_{false};
+    bool recovering_{false};
+
+    uint64_t recoveries_{0};
+    uint64_t snapshots_applied_{0};
+    uint64_t replayed_{0};
+    uint64_t stale_snapshots_{0};
+    uint64_t buffer_restarts_{0};
+    uint64_t skipped_{0};
+};
+
+}
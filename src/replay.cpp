@@ -0,0 +1,182 @@
+
+#include "replay.h"
+#include "wait_strategy.h"
+#include "utils/timestamp.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace market {
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+    fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Failed to stat " + path);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+
+    if (size_ != 0) {
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE;
+#endif
+        void* mapped = mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Failed to mmap " + path);
+        }
+        madvise(mapped, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(mapped);
+    }
+    close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        fallback_ = std::move(other.fallback_);
+        data_ = fallback_.empty() ? other.data_ : fallback_.data();
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void MappedFile::unmap() {
+#ifndef _WIN32
+    if (data_ != nullptr && fallback_.empty()) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    fallback_.clear();
+    data_ = nullptr;
+    size_ = 0;
+}
+
+CaptureReader::CaptureReader(const std::string& path) {
+    for (uint32_t index = 0;; ++index) {
+        const std::string name = CaptureJournal::file_name(path, index);
+        if (!std::ifstream(name)) {
+            break;
+        }
+        paths_.push_back(name);
+    }
+    if (paths_.empty()) {
+        paths_.push_back(path);
+    }
+
+    if (!open(0)) {
+        throw std::runtime_error("Not a capture journal: " + paths_[0]);
+    }
+}
+
+bool CaptureReader::open(size_t index) {
+    file_ = MappedFile(paths_[index]);
+    current_ = index;
+    total_bytes_ += file_.size();
+
+    CaptureFileHeader header{};
+    if (file_.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (header.magic != kCaptureMagic || header.version != kCaptureVersion) {
+        return false;
+    }
+    kernel_timestamps_ = (header.flags & kCaptureKernelTimestamps) != 0;
+    offset_ = sizeof(header);
+    return true;
+}
+
+bool CaptureReader::next(ReplayRecord& record) {
+    const size_t fixed = sizeof(CaptureRecordHeader) + (kernel_timestamps_ ? sizeof(uint64_t) : 0);
+
+    while (true) {
+        if (offset_ + fixed <= file_.size()) {
+            CaptureRecordHeader header{};
+            std::memcpy(&header, file_.data() + offset_, sizeof(header));
+            if (offset_ + fixed + header.len <= file_.size()) {
+                record.len = header.len;
+                record.recv_ns = header.recv_ns;
+                record.kernel_ns = 0;
+                if (kernel_timestamps_) {
+                    std::memcpy(&record.kernel_ns, file_.data() + offset_ + sizeof(header), sizeof(uint64_t));
+                }
+                record.data = file_.data() + offset_ + fixed;
+                offset_ += fixed + header.len;
+                return true;
+            }
+        }
+
+        if (offset_ != file_.size()) {
+            ++truncated_;
+        }
+        if (current_ + 1 >= paths_.size() || !open(current_ + 1)) {
+            return false;
+        }
+    }
+}
+
+void ReplayPacer::wait(uint64_t recv_ns) {
+    if (speed_ <= 0.0) {
+        return;
+    }
+
+    const uint64_t now = now_ns();
+    if (started_ns_ == 0) {
+        started_ns_ = now;
+        first_recv_ns_ = recv_ns;
+        return;
+    }
+
+    const double offset = recv_ns > first_recv_ns_ ? static_cast<double>(recv_ns - first_recv_ns_) / speed_ : 0.0;
+    const uint64_t due = started_ns_ + static_cast<uint64_t>(offset);
+    if (due <= now) {
+        return;
+    }
+    if (due - now > 100'000) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(due - now - 50'000));
+    }
+    while (now_ns() < due) {
+        cpu_relax();
+    }
+}
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "capture.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace market {
+
+struct ReplayRecord {
+    const char* data{nullptr};
+    uint32_t len{0};
+    uint64_t recv_ns{0};
+    uint64_t kernel_ns{0};
+};
+
+class MappedFile {
+public:
+
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+private:
+
+    void unmap();
+
+    const char* data_{nullptr};
+    size_t size_{0};
+    std::vector<char> fallback_;
+};
+
+class CaptureReader {
+public:
+
+    explicit CaptureReader(const std::string& path);
+
+    bool next(ReplayRecord& record);
+
+    size_t files() const {
+        return paths_.size();
+    }
+
+    uint64_t total_bytes() const {
+        return total_bytes_;
+    }
+
+    uint64_t truncated() const {
+        return truncated_;
+    }
+
+private:
+
+    bool open(size_t index);
+
+    std::vector<std::string> paths_;
+    size_t current_{0};
+    MappedFile file_;
+    size_t offset_{0};
+    bool kernel_timestamps_{false};
+    uint64_t total_bytes_{0};
+    uint64_t truncated_{0};
+};
+
+class ReplayPacer {
+public:
+
+    explicit ReplayPacer(double speed)
+        : speed_(speed) {}
+
+    void wait(uint64_t recv_ns);
+
+private:
+
+    double speed_;
+    uint64_t first_recv_ns_{0};
+    uint64_t started_ns_{0};
+};
+
+}
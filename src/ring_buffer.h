@@ -14,12 +14,36 @@ class SPSCRingBuffer {
 
     alignas(64) std::atomic<size_t> head_{0};
 
+    alignas(64) size_t cached_tail_{0};
+
     alignas(64) std::atomic<size_t> tail_{0};
 
+    alignas(64) size_t cached_head_{0};
+
     alignas(64) std::array<T, Size> buffer_;
 
     static constexpr size_t mask_ = Size - 1;
 
+    size_t free_slots(size_t head, size_t wanted) {
+
+        size_t available = (cached_tail_ - head - 1) & mask_;
+        if (available < wanted) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            available = (cached_tail_ - head - 1) & mask_;
+        }
+        return available;
+    }
+
+    size_t ready_slots(size_t tail, size_t wanted) {
+
+        size_t available = (cached_head_ - tail) & mask_;
+        if (available < wanted) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            available = (cached_head_ - tail) & mask_;
+        }
+        return available;
+    }
+
 public:
 
     SPSCRingBuffer() = default;
@@ -31,14 +55,12 @@ public:
 
         const size_t head = head_.load(std::memory_order_relaxed);
 
-        const size_t next = (head + 1) & mask_;
-
-        if (next == tail_.load(std::memory_order_acquire)) {
+        if (free_slots(head, 1) == 0) {
             return false;
         }
 
         buffer_[head] = item;
-        head_.store(next, std::memory_order_release);
+        head_.store((head + 1) & mask_, std::memory_order_release);
         return true;
     }
 
@@ -46,7 +68,7 @@ public:
 
         const size_t tail = tail_.load(std::memory_order_relaxed);
 
-        if (tail == head_.load(std::memory_order_acquire)) {
+        if (ready_slots(tail, 1) == 0) {
             return false;
         }
 
@@ -55,6 +77,86 @@ public:
         return true;
     }
 
+    size_t try_push_n(const T* items, size_t count) {
+
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t available = free_slots(head, count);
+        const size_t pushed = count < available ? count : available;
+
+        for (size_t idx = 0; idx < pushed; ++idx) {
+            buffer_[(head + idx) & mask_] = items[idx];
+        }
+
+        if (pushed > 0) {
+            head_.store((head + pushed) & mask_, std::memory_order_release);
+        }
+        return pushed;
+    }
+
+    size_t try_pop_n(T* items, size_t count) {
+
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t available = ready_slots(tail, count);
+        const size_t popped = count < available ? count : available;
+
+        for (size_t idx = 0; idx < popped; ++idx) {
+            items[idx] = buffer_[(tail + idx) & mask_];
+        }
+
+        if (popped > 0) {
+            tail_.store((tail + popped) & mask_, std::memory_order_release);
+        }
+        return popped;
+    }
+
+    T* try_claim() {
+
+        const size_t head = head_.load(std::memory_order_relaxed);
+
+        if (free_slots(head, 1) == 0) {
+            return nullptr;
+        }
+        return &buffer_[head];
+    }
+
+    void commit() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        head_.store((head + 1) & mask_, std::memory_order_release);
+    }
+
+    size_t try_claim_n(size_t count) {
+
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t available = free_slots(head, count);
+        return count < available ? count : available;
+    }
+
+    T& claimed(size_t index) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        return buffer_[(head + index) & mask_];
+    }
+
+    void commit_n(size_t count) {
+        assert(count < Size);
+        const size_t head = head_.load(std::memory_order_relaxed);
+        head_.store((head + count) & mask_, std::memory_order_release);
+    }
+
+    const T* peek() {
+
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+
+        if (ready_slots(tail, 1) == 0) {
+            return nullptr;
+        }
+        return &buffer_[tail];
+    }
+
+    void release() {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        tail_.store((tail + 1) & mask_, std::memory_order_release);
+    }
+
     size_t size() const {
         const size_t head = head_.load(std::memory_order_acquire);
         const size_t tail = tail_.load(std::memory_order_acquire);
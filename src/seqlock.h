@@ -0,0 +1,73 @@
+#pragma once
+
+#include "wait_strategy.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace market {
+
+template <typename T>
+class Seqlock {
+
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock payload must be trivially copyable");
+
+public:
+
+    void store(const T& value) {
+        std::array<uint64_t, kWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const uint32_t version = version_.load(std::memory_order_relaxed);
+        version_.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t idx = 0; idx < kWords; ++idx) {
+            words_[idx].store(words[idx], std::memory_order_relaxed);
+        }
+        version_.store(version + 2, std::memory_order_release);
+    }
+
+    bool try_load(T& out) const {
+        const uint32_t before = version_.load(std::memory_order_acquire);
+        if ((before & 1) != 0) {
+            return false;
+        }
+
+        std::array<uint64_t, kWords> words;
+        for (size_t idx = 0; idx < kWords; ++idx) {
+            words[idx] = words_[idx].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (version_.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+
+        std::memcpy(static_cast<void*>(&out), words.data(), sizeof(T));
+        return true;
+    }
+
+    T load() const {
+        T value;
+        while (!try_load(value)) {
+            cpu_relax();
+        }
+        return value;
+    }
+
+    uint32_t version() const {
+        return version_.load(std::memory_order_acquire);
+    }
+
+private:
+
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> version_{0};
+    std::array<std::atomic<uint64_t>, kWords> words_{};
+};
+
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "bbo_table.h"
+#include "book_manager.h"
+#include "market_data.h"
+#include "message_handler.h"
+#include "ring_buffer.h"
+#include "trade_analytics.h"
+#include "wait_strategy.h"
+#include "utils/cpu.h"
+#include "utils/stats.h"
+#include "utils/timestamp.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace market {
+
+struct ShardMessage {
+
+    static constexpr size_t MaxPayload = 48;
+
+    std::array<char, MaxPayload> payload;
+    uint64_t recv_cycles;
+    uint64_t kernel_cycles;
+};
+
+static_assert(sizeof(ShardMessage) == 64, "ShardMessage must fill exactly one cache line");
+static_assert(sizeof(Quote) <= ShardMessage::MaxPayload && sizeof(OrderAdd) <= ShardMessage::MaxPayload &&
+              sizeof(OrderCancel) <= ShardMessage::MaxPayload && sizeof(Trade) <= ShardMessage::MaxPayload &&
+              sizeof(BookReset) <= ShardMessage::MaxPayload && sizeof(LevelSet) <= ShardMessage::MaxPayload &&
+              sizeof(OrderExecute) <= ShardMessage::MaxPayload && sizeof(OrderModify) <= ShardMessage::MaxPayload &&
+              sizeof(OrderReplace) <= ShardMessage::MaxPayload,
+              "every message type must fit a shard slot");
+
+using ShardRing = SPSCRingBuffer<ShardMessage, 16384>;
+
+struct ShardStats {
+    LatencyStats latency;
+    LatencyStats queue;
+    LatencyStats wire;
+    uint64_t messages{0};
+    uint32_t active_books{0};
+    uint64_t unrouted{0};
+    uint64_t rejected{0};
+    uint32_t stale_books{0};
+
+    void reset() {
+        latency.reset();
+        queue.reset();
+        wire.reset();
+        messages = 0;
+    }
+};
+
+struct ShardConfig {
+    uint32_t universe_size{1024};
+    uint32_t max_symbol_id{65535};
+    BookConfig book;
+    TradeAnalyticsConfig trades;
+    std::vector<uint32_t> watch_symbols;
+    BboTable* bbo{nullptr};
+    ShmBookPublisher* shm{nullptr};
+    WaitMode wait{WaitMode::Yield};
+    uint32_t spin_limit{20'000};
+    ThreadPlacement placement;
+};
+
+inline uint32_t shard_of(uint32_t symbol_id, uint32_t shard_count) {
+    const uint32_t mixed = symbol_id * 0x9E3779B9u;
+    return static_cast<uint32_t>((static_cast<uint64_t>(mixed) * shard_count) >> 32);
+}
+
+template <typename Book>
+class ProcessorShard {
+public:
+
+    explicit ProcessorShard(const ShardConfig& config)
+        : config_(config), ring_(std::make_unique<ShardRing>()) {}
+
+    ~ProcessorShard() {
+        stop();
+    }
+
+    ProcessorShard(const ProcessorShard&) = delete;
+    ProcessorShard& operator=(const ProcessorShard&) = delete;
+
+    void start() {
+        running_.store(true, std::memory_order_release);
+        thread_ = std::thread([this]() { run(); });
+        while (!ready_.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void stop() {
+        running_.store(false, std::memory_order_release);
+        doorbell_.notify();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    bool try_push(const MessageHeader* header, uint64_t recv_cycles, uint64_t kernel_cycles) {
+        ShardMessage* slot = ring_->try_claim();
+        if (slot == nullptr) {
+            return false;
+        }
+
+        std::memcpy(slot->payload.data(), header, header->msg_len);
+        slot->recv_cycles = recv_cycles;
+        slot->kernel_cycles = kernel_cycles;
+        ring_->commit();
+        return true;
+    }
+
+    void notify() {
+        doorbell_.notify();
+    }
+
+    void request_stats(uint64_t epoch) {
+        requested_.store(epoch, std::memory_order_release);
+        doorbell_.notify();
+    }
+
+    bool stats_ready(uint64_t epoch) const {
+        return published_.load(std::memory_order_acquire) == epoch;
+    }
+
+    const ShardStats& stats(uint64_t epoch) const {
+        return published_stats_[epoch & 1];
+    }
+
+    const std::string& placement() const {
+        return placement_;
+    }
+
+    const TradeAnalytics& trades() const {
+        return *trades_;
+    }
+
+private:
+
+    void run() {
+        placement_ = apply_thread_placement(config_.placement);
+
+        books_ = std::make_unique<BookManager<Book>>(config_.universe_size, config_.max_symbol_id, config_.book);
+        trades_ = std::make_unique<TradeAnalytics>(config_.universe_size, config_.max_symbol_id, config_.trades);
+        books_->publish_bbo(config_.bbo);
+        books_->publish_shm(config_.shm);
+        for (const uint32_t symbol : config_.watch_symbols) {
+            books_->register_symbol(symbol);
+        }
+        ready_.store(true, std::memory_order_release);
+
+        HandlerChain<TradeAnalytics, BookManager<Book>> handlers(*trades_, *books_);
+        IdleWaiter waiter(config_.wait, &doorbell_, config_.spin_limit);
+        auto has_work = [this]() {
+            return ring_->size() > 0 || requested_.load(std::memory_order_relaxed) != last_published_ ||
+                   !running_.load(std::memory_order_relaxed);
+        };
+
+        while (running_.load(std::memory_order_acquire) || ring_->size() > 0) {
+
+            publish_if_requested();
+
+            const ShardMessage* message = ring_->peek();
+            if (message == nullptr) {
+                waiter.idle(has_work);
+                continue;
+            }
+            waiter.reset();
+
+            const uint64_t now = rdtsc();
+            const uint64_t recv = message->recv_cycles;
+            const uint64_t kernel = message->kernel_cycles;
+            working_stats_.latency.record(now > recv ? now - recv : 0);
+            if (kernel != 0) {
+                working_stats_.queue.record(recv > kernel ? recv - kernel : 0);
+                working_stats_.wire.record(now > kernel ? now - kernel : 0);
+            }
+            ++working_stats_.messages;
+
+            handlers.on_message(reinterpret_cast<const MessageHeader*>(message->payload.data()));
+            ring_->release();
+        }
+        publish_if_requested();
+    }
+
+    void publish_if_requested() {
+        const uint64_t requested = requested_.load(std::memory_order_acquire);
+        if (requested == last_published_) {
+            return;
+        }
+
+        working_stats_.active_books = books_->active_symbols();
+        working_stats_.unrouted = books_->unrouted_messages();
+        working_stats_.rejected = books_->rejected_orders();
+        working_stats_.stale_books = books_->stale_books();
+
+        std::swap(working_stats_, published_stats_[requested & 1]);
+        working_stats_.reset();
+
+        last_published_ = requested;
+        published_.store(requested, std::memory_order_release);
+    }
+
+    ShardConfig config_;
+    std::unique_ptr<ShardRing> ring_;
+    std::unique_ptr<BookManager<Book>> books_;
+    std::unique_ptr<TradeAnalytics> trades_;
+    std::thread thread_;
+    std::string placement_;
+    Doorbell doorbell_;
+
+    ShardStats working_stats_;
+    ShardStats published_stats_[2];
+    uint64_t last_published_{0};
+
+    alignas(64) std::atomic<uint64_t> requested_{0};
+    alignas(64) std::atomic<uint64_t> published_{0};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> ready_{false};
+};
+
+}
@@ -0,0 +1,130 @@
+
+#include "shm_book.h"
+#include "utils/timestamp.h"
+
+#include <new>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace market {
+
+namespace {
+
+constexpr size_t kHeaderBytes = sizeof(ShmBookHeader);
+constexpr size_t kRecordBytes = sizeof(ShmBookRecord);
+
+}
+
+#ifdef _WIN32
+
+ShmBookPublisher::ShmBookPublisher(const std::string& name, uint32_t, uint32_t)
+    : name_(name), symbol_count_(0), depth_(0) {
+    throw std::runtime_error("Shared-memory publication needs POSIX shm_open");
+}
+
+ShmBookPublisher::~ShmBookPublisher() = default;
+
+ShmBookReader::ShmBookReader(const std::string&) {
+    throw std::runtime_error("Shared-memory publication needs POSIX shm_open");
+}
+
+ShmBookReader::~ShmBookReader() = default;
+
+#else
+
+ShmBookPublisher::ShmBookPublisher(const std::string& name, uint32_t max_symbol_id, uint32_t depth)
+    : name_(name), symbol_count_(max_symbol_id + 1), depth_(depth) {
+
+    if (depth_ == 0 || depth_ > kShmMaxDepth) {
+        throw std::invalid_argument("Shared-memory depth must be between 1 and " + std::to_string(kShmMaxDepth));
+    }
+
+    shm_unlink(name_.c_str());
+    const int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create shared memory " + name_);
+    }
+
+    bytes_ = kHeaderBytes + static_cast<size_t>(symbol_count_) * kRecordBytes;
+    if (ftruncate(fd, static_cast<off_t>(bytes_)) != 0) {
+        close(fd);
+        shm_unlink(name_.c_str());
+        throw std::runtime_error("Failed to size shared memory " + name_);
+    }
+
+    void* mapped = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        shm_unlink(name_.c_str());
+        throw std::runtime_error("Failed to mmap shared memory " + name_);
+    }
+
+    header_ = new (mapped) ShmBookHeader{};
+    records_ = reinterpret_cast<ShmBookRecord*>(static_cast<char*>(mapped) + kHeaderBytes);
+    header_->layout = kShmBookLayout;
+    header_->header_bytes = static_cast<uint32_t>(kHeaderBytes);
+    header_->record_bytes = static_cast<uint32_t>(kRecordBytes);
+    header_->max_depth = kShmMaxDepth;
+    header_->depth = depth_;
+    header_->symbol_count = symbol_count_;
+    header_->writer_pid = static_cast<uint64_t>(getpid());
+    header_->start_ns = realtime_ns();
+    header_->heartbeat_ns.store(header_->start_ns, std::memory_order_relaxed);
+    header_->magic.store(kShmBookMagic, std::memory_order_release);
+}
+
+ShmBookPublisher::~ShmBookPublisher() {
+    header_->closed.store(1, std::memory_order_release);
+    munmap(header_, bytes_);
+    shm_unlink(name_.c_str());
+}
+
+ShmBookReader::ShmBookReader(const std::string& name) {
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open shared memory " + name);
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Failed to stat shared memory " + name);
+    }
+    bytes_ = static_cast<size_t>(info.st_size);
+    if (bytes_ < kHeaderBytes) {
+        close(fd);
+        throw std::runtime_error("Not a book region: " + name);
+    }
+
+    void* mapped = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Failed to mmap shared memory " + name);
+    }
+
+    header_ = static_cast<const ShmBookHeader*>(mapped);
+    records_ = reinterpret_cast<const ShmBookRecord*>(static_cast<const char*>(mapped) + kHeaderBytes);
+
+    const bool valid = header_->magic.load(std::memory_order_acquire) == kShmBookMagic &&
+                       header_->layout == kShmBookLayout && header_->header_bytes == kHeaderBytes &&
+                       header_->record_bytes == kRecordBytes && header_->max_depth == kShmMaxDepth &&
+                       kHeaderBytes + static_cast<size_t>(header_->symbol_count) * kRecordBytes <= bytes_;
+    if (!valid) {
+        munmap(mapped, bytes_);
+        throw std::runtime_error("Incompatible or uninitialised book region: " + name);
+    }
+}
+
+ShmBookReader::~ShmBookReader() {
+    munmap(const_cast<ShmBookHeader*>(header_), bytes_);
+}
+
+#endif
+
+}
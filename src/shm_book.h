@@ -0,0 +1,200 @@
+#pragma once
+
+#include "market_data.h"
+#include "seqlock.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace market {
+
+constexpr uint64_t kShmBookMagic = 0x314B4F4F4244444Dull;  // "MDDBOOK1"
+constexpr uint32_t kShmBookLayout = 2;
+constexpr uint32_t kShmMaxDepth = 10;
+
+struct ShmLevel {
+    int64_t price{0};
+    uint32_t size{0};
+    uint32_t reserved{0};
+};
+
+struct ShmBook {
+    uint32_t symbol_id{0};
+    uint32_t sequence_num{0};
+    uint64_t timestamp_ns{0};
+    uint32_t bid_levels{0};
+    uint32_t ask_levels{0};
+    uint32_t stale{0};
+    uint32_t reserved{0};
+    ShmLevel bids[kShmMaxDepth];
+    ShmLevel asks[kShmMaxDepth];
+};
+
+struct alignas(64) ShmBookRecord {
+    Seqlock<ShmBook> book;
+};
+
+struct alignas(64) ShmBookHeader {
+    std::atomic<uint64_t> magic;
+    uint32_t layout;
+    uint32_t header_bytes;
+    uint32_t record_bytes;
+    uint32_t max_depth;
+    uint32_t depth;
+    uint32_t symbol_count;
+    uint64_t writer_pid;
+    uint64_t start_ns;
+    std::atomic<uint64_t> heartbeat_ns;
+    std::atomic<uint32_t> closed;
+};
+
+static_assert(sizeof(ShmBookHeader) == 64, "ShmBookHeader must fill exactly one cache line");
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory atomics must be address-free");
+
+class ShmBookPublisher {
+public:
+
+    ShmBookPublisher(const std::string& name, uint32_t max_symbol_id, uint32_t depth);
+
+    ~ShmBookPublisher();
+
+    ShmBookPublisher(const ShmBookPublisher&) = delete;
+    ShmBookPublisher& operator=(const ShmBookPublisher&) = delete;
+
+    template <typename Book>
+    void update(uint32_t symbol_id, const MessageHeader& header, const Book& book, ShmBook& last, char side = 0,
+                int64_t price = 0) {
+        if (symbol_id >= symbol_count_ || below_top(last, side, price)) {
+            return;
+        }
+
+        bool changed = false;
+        changed |= refresh(book, 'B', last.bids, last.bid_levels);
+        changed |= refresh(book, 'S', last.asks, last.ask_levels);
+        if (!changed) {
+            return;
+        }
+
+        last.symbol_id = symbol_id;
+        last.sequence_num = header.sequence_num;
+        last.timestamp_ns = header.timestamp_ns;
+        records_[symbol_id].book.store(last);
+    }
+
+    void set_stale(uint32_t symbol_id, ShmBook& last, bool stale) {
+        if (symbol_id >= symbol_count_ || last.stale == static_cast<uint32_t>(stale)) {
+            return;
+        }
+
+        last.symbol_id = symbol_id;
+        last.stale = stale ? 1 : 0;
+        records_[symbol_id].book.store(last);
+    }
+
+    void heartbeat(uint64_t realtime_ns) {
+        header_->heartbeat_ns.store(realtime_ns, std::memory_order_release);
+    }
+
+    const std::string& name() const {
+        return name_;
+    }
+
+    size_t bytes() const {
+        return bytes_;
+    }
+
+    uint32_t depth() const {
+        return depth_;
+    }
+
+private:
+
+    bool below_top(const ShmBook& last, char side, int64_t price) const {
+        if (side == 'B') {
+            return last.bid_levels == depth_ && price < last.bids[depth_ - 1].price;
+        }
+        if (side == 'S') {
+            return last.ask_levels == depth_ && price > last.asks[depth_ - 1].price;
+        }
+        return false;
+    }
+
+    template <typename Book>
+    bool refresh(const Book& book, char side, ShmLevel* levels, uint32_t& count) const {
+        bool changed = false;
+        uint32_t filled = 0;
+        book.levels().for_each_level(side, static_cast<int>(depth_), [&](int64_t price, uint32_t size) {
+            ShmLevel& level = levels[filled++];
+            if (level.price != price || level.size != size) {
+                level = ShmLevel{price, size, 0};
+                changed = true;
+            }
+        });
+        for (uint32_t idx = filled; idx < count; ++idx) {
+            levels[idx] = ShmLevel{};
+        }
+        changed |= filled != count;
+        count = filled;
+        return changed;
+    }
+
+    std::string name_;
+    uint32_t symbol_count_;
+    uint32_t depth_;
+    size_t bytes_{0};
+    ShmBookHeader* header_{nullptr};
+    ShmBookRecord* records_{nullptr};
+};
+
+class ShmBookReader {
+public:
+
+    explicit ShmBookReader(const std::string& name);
+
+    ~ShmBookReader();
+
+    ShmBookReader(const ShmBookReader&) = delete;
+    ShmBookReader& operator=(const ShmBookReader&) = delete;
+
+    bool read(uint32_t symbol_id, ShmBook& out) const {
+        if (symbol_id >= header_->symbol_count || records_[symbol_id].book.version() == 0) {
+            return false;
+        }
+        for (uint32_t attempt = 0; attempt < kReadAttempts; ++attempt) {
+            if (records_[symbol_id].book.try_load(out)) {
+                return true;
+            }
+            cpu_relax();
+        }
+        return false;
+    }
+
+    uint32_t version(uint32_t symbol_id) const {
+        return symbol_id < header_->symbol_count ? records_[symbol_id].book.version() : 0;
+    }
+
+    const ShmBookHeader& header() const {
+        return *header_;
+    }
+
+    uint64_t heartbeat_ns() const {
+        return header_->heartbeat_ns.load(std::memory_order_acquire);
+    }
+
+    bool writer_closed() const {
+        return header_->closed.load(std::memory_order_acquire) != 0;
+    }
+
+private:
+
+    static constexpr uint32_t kReadAttempts = 1 << 16;
+
+    size_t bytes_{0};
+    const ShmBookHeader* header_{nullptr};
+    const ShmBookRecord* records_{nullptr};
+};
+
+}
@@ -0,0 +1,84 @@
+
+#include "trade_analytics.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace market {
+
+TradeAnalytics::TradeAnalytics(uint32_t universe_size, uint32_t max_symbol_id, const TradeAnalyticsConfig& config)
+    : config_(config),
+      universe_size_(universe_size),
+      slot_count_(max_symbol_id + 1),
+      slot_of_(new std::atomic<uint32_t>[static_cast<size_t>(max_symbol_id) + 1]),
+      symbols_(new SymbolTrades[universe_size]) {
+
+    if (universe_size == 0) {
+        throw std::invalid_argument("TradeAnalytics universe size must be non-zero");
+    }
+
+    config_.bar_ns = std::max<uint64_t>(1, config_.bar_ns);
+    config_.bar_history = std::max<uint32_t>(1, config_.bar_history);
+    bars_.reset(new Seqlock<IndexedBar>[static_cast<size_t>(universe_size) * config_.bar_history]);
+
+    for (uint32_t symbol = 0; symbol < slot_count_; ++symbol) {
+        slot_of_[symbol].store(kNoSlot, std::memory_order_relaxed);
+    }
+}
+
+bool TradeAnalytics::snapshot(uint32_t symbol_id, TradeSnapshot& out) const {
+    const uint32_t slot = slot_of(symbol_id);
+    if (slot == kNoSlot) {
+        return false;
+    }
+
+    out = symbols_[slot].published.load();
+    return true;
+}
+
+bool TradeAnalytics::bar(uint32_t symbol_id, uint32_t back, OhlcvBar& out) const {
+    const uint32_t slot = slot_of(symbol_id);
+    if (slot == kNoSlot) {
+        return false;
+    }
+
+    const uint64_t completed = symbols_[slot].completed_bars.load(std::memory_order_acquire);
+    if (back >= completed || back >= config_.bar_history) {
+        return false;
+    }
+
+    const uint64_t index = completed - 1 - back;
+    const IndexedBar entry = bars_[static_cast<size_t>(slot) * config_.bar_history + index % config_.bar_history].load();
+    if (entry.index != index) {
+        return false;
+    }
+    out = entry.bar;
+    return true;
+}
+
+uint32_t TradeAnalytics::active_symbols() const {
+    return next_slot_.load(std::memory_order_acquire);
+}
+
+uint64_t TradeAnalytics::unrouted_trades() const {
+    return unrouted_.load(std::memory_order_relaxed);
+}
+
+uint32_t TradeAnalytics::slot_of(uint32_t symbol_id) const {
+    if (symbol_id >= slot_count_) {
+        return kNoSlot;
+    }
+    return slot_of_[symbol_id].load(std::memory_order_acquire);
+}
+
+void TradeAnalytics::close_bar(uint32_t slot, SymbolTrades& symbol) {
+    const uint64_t index = symbol.completed_bars.load(std::memory_order_relaxed);
+    IndexedBar entry;
+    entry.index = index;
+    entry.bar = symbol.state.bar;
+    bars_[static_cast<size_t>(slot) * config_.bar_history + index % config_.bar_history].store(entry);
+    symbol.completed_bars.store(index + 1, std::memory_order_release);
+    symbol.state.bar = OhlcvBar{};
+}
+
+}
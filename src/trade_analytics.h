@@ -0,0 +1,159 @@
+#pragma once
+
+#include "market_data.h"
+#include "message_handler.h"
+#include "seqlock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace market {
+
+struct TradeAnalyticsConfig {
+    uint64_t bar_ns{1'000'000'000};
+    uint32_t bar_history{60};
+};
+
+struct OhlcvBar {
+    uint64_t start_ns{0};
+    int64_t open{0};
+    int64_t high{0};
+    int64_t low{0};
+    int64_t close{0};
+    uint64_t volume{0};
+    uint64_t trades{0};
+};
+
+struct TradeSnapshot {
+    uint32_t symbol_id{0};
+    uint32_t last_size{0};
+    int64_t last_price{0};
+    uint64_t last_ns{0};
+    uint64_t trades{0};
+    uint64_t volume{0};
+    uint64_t buy_volume{0};
+    uint64_t sell_volume{0};
+    double notional{0.0};
+    OhlcvBar bar;
+
+    double vwap() const {
+        return volume == 0 ? 0.0 : notional / static_cast<double>(volume);
+    }
+};
+
+class TradeAnalytics : public MessageHandler<TradeAnalytics> {
+public:
+
+    static constexpr uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+
+    TradeAnalytics(uint32_t universe_size, uint32_t max_symbol_id,
+                   const TradeAnalyticsConfig& config = TradeAnalyticsConfig{});
+
+    TradeAnalytics(const TradeAnalytics&) = delete;
+    TradeAnalytics& operator=(const TradeAnalytics&) = delete;
+
+    void on_trade(const Trade& msg) {
+        SymbolTrades* symbol = route(msg.symbol_id);
+        if (symbol == nullptr) {
+            return;
+        }
+
+        TradeSnapshot& state = symbol->state;
+        const uint64_t bucket = msg.header.timestamp_ns / config_.bar_ns * config_.bar_ns;
+        if (state.bar.trades != 0 && bucket > state.bar.start_ns) {
+            close_bar(static_cast<uint32_t>(symbol - symbols_.get()), *symbol);
+        }
+
+        OhlcvBar& bar = state.bar;
+        if (bar.trades == 0) {
+            bar.start_ns = bucket;
+            bar.open = msg.price;
+            bar.high = msg.price;
+            bar.low = msg.price;
+        }
+        bar.high = std::max(bar.high, msg.price);
+        bar.low = std::min(bar.low, msg.price);
+        bar.close = msg.price;
+        bar.volume += msg.size;
+        ++bar.trades;
+
+        state.last_price = msg.price;
+        state.last_size = msg.size;
+        state.last_ns = msg.header.timestamp_ns;
+        ++state.trades;
+        state.volume += msg.size;
+        state.notional += static_cast<double>(msg.price) * msg.size;
+        if (msg.side == 'B') {
+            state.buy_volume += msg.size;
+        } else if (msg.side == 'S') {
+            state.sell_volume += msg.size;
+        }
+
+        symbol->published.store(state);
+    }
+
+    bool snapshot(uint32_t symbol_id, TradeSnapshot& out) const;
+
+    bool bar(uint32_t symbol_id, uint32_t back, OhlcvBar& out) const;
+
+    uint32_t active_symbols() const;
+
+    uint64_t unrouted_trades() const;
+
+    const TradeAnalyticsConfig& config() const {
+        return config_;
+    }
+
+private:
+
+    struct IndexedBar {
+        uint64_t index{0};
+        OhlcvBar bar;
+    };
+
+    struct SymbolTrades {
+        TradeSnapshot state;
+        Seqlock<TradeSnapshot> published;
+        std::atomic<uint64_t> completed_bars{0};
+    };
+
+    SymbolTrades* route(uint32_t symbol_id) {
+        if (symbol_id >= slot_count_) {
+            unrouted_.store(unrouted_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        uint32_t slot = slot_of_[symbol_id].load(std::memory_order_relaxed);
+        if (slot == kNoSlot) {
+
+            slot = next_slot_.load(std::memory_order_relaxed);
+            if (slot == universe_size_) {
+                unrouted_.store(unrouted_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            symbols_[slot].state.symbol_id = symbol_id;
+            symbols_[slot].published.store(symbols_[slot].state);
+            slot_of_[symbol_id].store(slot, std::memory_order_release);
+            next_slot_.store(slot + 1, std::memory_order_release);
+        }
+        return &symbols_[slot];
+    }
+
+    uint32_t slot_of(uint32_t symbol_id) const;
+
+    void close_bar(uint32_t slot, SymbolTrades& symbol);
+
+    TradeAnalyticsConfig config_;
+    uint32_t universe_size_;
+    uint32_t slot_count_;
+    std::unique_ptr<std::atomic<uint32_t>[]> slot_of_;
+    std::unique_ptr<SymbolTrades[]> symbols_;
+    std::unique_ptr<Seqlock<IndexedBar>[]> bars_;
+    std::atomic<uint32_t> next_slot_{0};
+    std::atomic<uint64_t> unrouted_{0};
+};
+
+}
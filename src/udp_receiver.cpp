@@ -3,6 +3,8 @@
 #include "utils/timestamp.h"
 
 #include <array>
+#include <cstring>
+#include <vector>
  #include <stdexcept>
  #include <thread>
 
@@ -15,9 +17,11 @@
  #include <errno.h>
  #include <fcntl.h>
  #include <netinet/in.h>
+ #include <poll.h>
  #include <sys/socket.h>
  #include <sys/types.h>
  #include <sys/uio.h>
+ #include <time.h>
  #include <unistd.h>
 #endif
 
@@ -53,15 +57,113 @@
  }
  #endif
 
- UDPReceiver::UDPReceiver(const std::string& multicast_ip, uint16_t port)
-     : multicast_ip_(multicast_ip), port_(port) {
+#if defined(__linux__)
+ namespace {
+
+ class ReceiveBatch {
+ public:
+
+     explicit ReceiveBatch(size_t count)
+         : msg_vec_(count), iovecs_(count), control_(count) {
+         for (size_t idx = 0; idx < count; ++idx) {
+             iovecs_[idx].iov_len = RawMessage::MaxPayload;
+             msg_vec_[idx].msg_hdr.msg_iov = &iovecs_[idx];
+             msg_vec_[idx].msg_hdr.msg_iovlen = 1;
+             msg_vec_[idx].msg_hdr.msg_control = control_[idx].data;
+         }
+     }
+
+     void target(size_t idx, char* buffer) {
+         iovecs_[idx].iov_base = buffer;
+     }
+
+     int receive(socket_handle_t fd, size_t count, int flags) {
+         for (size_t idx = 0; idx < count; ++idx) {
+             msg_vec_[idx].msg_hdr.msg_controllen = sizeof(control_[idx].data);
+         }
+         return recvmmsg(fd, msg_vec_.data(), static_cast<unsigned int>(count), flags, nullptr);
+     }
+
+     size_t length(size_t idx) const {
+         return static_cast<size_t>(msg_vec_[idx].msg_len);
+     }
+
+     uint64_t kernel_ns(size_t idx) {
+         msghdr& hdr = msg_vec_[idx].msg_hdr;
+         for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+             if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                 timespec ts{};
+                 std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                 return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ULL + static_cast<uint64_t>(ts.tv_nsec);
+             }
+         }
+         return 0;
+     }
+
+ private:
+
+     union ControlBuffer {
+         char data[CMSG_SPACE(sizeof(timespec))];
+         cmsghdr align;
+     };
+
+     std::vector<mmsghdr> msg_vec_;
+     std::vector<iovec> iovecs_;
+     std::vector<ControlBuffer> control_;
+ };
+
+ }
+#endif
+
+ namespace {
+
+ void close_socket(socket_handle_t fd) {
+     if (fd == kInvalidSocket) {
+         return;
+     }
+
+ #ifdef _WIN32
+     closesocket(fd);
+ #else
+     close(fd);
+ #endif
+ }
+
+ }
+
+ UDPReceiver::UDPReceiver(const std::string& multicast_ip, uint16_t port, const ReceiverConfig& config)
+     : multicast_ip_(multicast_ip), port_(port), config_(config) {
+
+     if (config_.batch_size == 0) {
+         config_.batch_size = 1;
+     }
 
  #ifdef _WIN32
      WSAInitializer::ensure();
  #endif
 
-     socket_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
-     if (socket_fd_ == kInvalidSocket) {
+     if (!config_.line_b_ip.empty()) {
+         line_count_ = 2;
+     }
+
+     const bool blocking = line_count_ == 1 &&
+                           (config_.wait == WaitMode::Block || config_.wait == WaitMode::BusyPoll);
+
+     sockets_[0] = open_line(multicast_ip_, port_, blocking);
+     if (line_count_ > 1) {
+         try {
+             sockets_[1] = open_line(config_.line_b_ip, config_.line_b_port != 0 ? config_.line_b_port : port_, blocking);
+         } catch (...) {
+             close_socket(sockets_[0]);
+             throw;
+         }
+     }
+ }
+
+ socket_handle_t UDPReceiver::open_line(const std::string& multicast_ip, uint16_t port, bool blocking) {
+
+     const socket_handle_t fd = socket(AF_INET, SOCK_DGRAM, 0);
+     if (fd == kInvalidSocket) {
          throw std::runtime_error("Failed to create UDP socket");
      }
 
@@ -70,71 +172,109 @@
 
     DWORD bytes_returned = 0;
     BOOL new_behavior = FALSE;
-    WSAIoctl(socket_fd_, SIO_UDP_CONNRESET, &new_behavior, sizeof(new_behavior),
+    WSAIoctl(fd, SIO_UDP_CONNRESET, &new_behavior, sizeof(new_behavior),
              nullptr, 0, &bytes_returned, nullptr, nullptr);
 #endif
 #endif
 
      int reuse = 1;
-     if (setsockopt(socket_fd_, SOL_SOCKET, SO_REUSEADDR,
+     if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR,
                     reinterpret_cast<char*>(&reuse), sizeof(reuse)) < 0) {
          throw std::runtime_error("Failed to set SO_REUSEADDR");
      }
 
      int recv_buf = 16 * 1024 * 1024;
-     setsockopt(socket_fd_, SOL_SOCKET, SO_RCVBUF,
+     setsockopt(fd, SOL_SOCKET, SO_RCVBUF,
                 reinterpret_cast<char*>(&recv_buf), sizeof(recv_buf));
 
      sockaddr_in local_addr{};
      local_addr.sin_family = AF_INET;
-     local_addr.sin_port = htons(port_);
+     local_addr.sin_port = htons(port);
      local_addr.sin_addr.s_addr = htonl(INADDR_ANY);
 
-     if (bind(socket_fd_, reinterpret_cast<sockaddr*>(&local_addr), sizeof(local_addr)) < 0) {
+     if (bind(fd, reinterpret_cast<sockaddr*>(&local_addr), sizeof(local_addr)) < 0) {
          throw std::runtime_error("Failed to bind UDP socket");
      }
 
      ip_mreq mreq{};
 
-     if (inet_pton(AF_INET, multicast_ip_.c_str(), &mreq.imr_multiaddr) != 1) {
+     if (inet_pton(AF_INET, multicast_ip.c_str(), &mreq.imr_multiaddr) != 1) {
          throw std::runtime_error("Invalid multicast address");
      }
 
      mreq.imr_interface.s_addr = htonl(INADDR_ANY);
 
-     if (setsockopt(socket_fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+     if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP,
                     reinterpret_cast<char*>(&mreq), sizeof(mreq)) < 0) {
          throw std::runtime_error("Failed to join multicast group");
      }
 
+#if defined(__linux__)
+     int multicast_all = 0;
+     setsockopt(fd, IPPROTO_IP, IP_MULTICAST_ALL, &multicast_all, sizeof(multicast_all));
+
+     int timestamps = 1;
+     setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &timestamps, sizeof(timestamps));
+
+     if (config_.wait == WaitMode::BusyPoll) {
+         int busy_poll = config_.busy_poll_us;
+         setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll, sizeof(busy_poll));
+     }
+
+     if (blocking) {
+         timeval timeout{};
+         timeout.tv_usec = 100'000;
+         setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+         recv_flags_ = MSG_WAITFORONE;
+         return fd;
+     }
+#else
+     (void)blocking;
+#endif
+
  #ifdef _WIN32
      u_long non_block = 1;
-     ioctlsocket(socket_fd_, FIONBIO, &non_block);
+     ioctlsocket(fd, FIONBIO, &non_block);
  #else
-     const int flags = fcntl(socket_fd_, F_GETFL, 0);
-     fcntl(socket_fd_, F_SETFL, flags | O_NONBLOCK);
+     const int flags = fcntl(fd, F_GETFL, 0);
+     fcntl(fd, F_SETFL, flags | O_NONBLOCK);
  #endif
+     return fd;
  }
 
  UDPReceiver::~UDPReceiver() {
      stop();
-     if (socket_fd_ != kInvalidSocket) {
+     for (const socket_handle_t fd : sockets_) {
+         close_socket(fd);
+     }
+ }
 
- #ifdef _WIN32
-         closesocket(socket_fd_);
- #else
-         close(socket_fd_);
- #endif
+ void UDPReceiver::start(RawMessageRing& output_queue, Doorbell* doorbell) {
+     if (running_.load(std::memory_order_relaxed)) {
+         return;
      }
+     doorbell_ = doorbell;
+     running_.store(true, std::memory_order_release);
+
+     receiver_thread_ = std::thread([this, &output_queue]() {
+         place_thread();
+         run(output_queue);
+     });
+     wait_until_placed();
  }
 
- void UDPReceiver::start(SPSCRingBuffer<RawMessage, 65536>& output_queue) {
+ void UDPReceiver::start(DatagramRing& output_queue, Doorbell* doorbell) {
      if (running_.load(std::memory_order_relaxed)) {
          return;
      }
+     doorbell_ = doorbell;
      running_.store(true, std::memory_order_release);
 
-     receiver_thread_ = std::thread(&UDPReceiver::run, this, std::ref(output_queue));
+     receiver_thread_ = std::thread([this, &output_queue]() {
+         place_thread();
+         run(output_queue);
+     });
+     wait_until_placed();
  }
 
  void UDPReceiver::stop() {
@@ -156,91 +296,342 @@
      return push_failures_.load(std::memory_order_acquire);
  }
 
- void UDPReceiver::run(SPSCRingBuffer<RawMessage, 65536>& output_queue) {
+ const std::string& UDPReceiver::placement() const {
+     wait_until_placed();
+     return placement_;
+ }
+
+ size_t UDPReceiver::line_count() const {
+     return line_count_;
+ }
+
+ LineStats UDPReceiver::line_stats(size_t line) const {
+     return arbiter_.stats(line);
+ }
+
+ void UDPReceiver::place_thread() {
+     placement_ = apply_thread_placement(config_.placement);
+     placed_.store(true, std::memory_order_release);
+ }
+
+ void UDPReceiver::wait_until_placed() const {
+     while (receiver_thread_.joinable() && !placed_.load(std::memory_order_acquire)) {
+         std::this_thread::yield();
+     }
+ }
+
+ void UDPReceiver::wait_for_data(uint32_t& idle_spins) const {
+     switch (config_.wait) {
+         case WaitMode::Spin:
+             cpu_relax();
+             return;
 
 #if defined(__linux__)
-     static constexpr size_t BatchSize = 8;
+         case WaitMode::Block:
+         case WaitMode::BusyPoll:
+             if (line_count_ == 1) {
+                 return;
+             }
+             break;
+#endif
+
+         case WaitMode::Backoff:
+             if (idle_spins < config_.spin_limit) {
+                 ++idle_spins;
+                 cpu_relax();
+                 return;
+             }
+             break;
 
-     std::array<RawMessage, BatchSize> batch_buffer{};
-     std::array<mmsghdr, BatchSize> msg_vec{};
-     std::array<iovec, BatchSize> iovecs{};
+         case WaitMode::Yield:
+         default:
+             std::this_thread::yield();
+             return;
+     }
 
-     for (size_t idx = 0; idx < BatchSize; ++idx) {
-         iovecs[idx].iov_base = batch_buffer[idx].payload.data();
-         iovecs[idx].iov_len = RawMessage::MaxPayload;
-         msg_vec[idx].msg_hdr.msg_iov = &iovecs[idx];
-         msg_vec[idx].msg_hdr.msg_iovlen = 1;
+#ifdef _WIN32
+     std::array<WSAPOLLFD, LineArbiter::MaxLines> ready{};
+     for (size_t line = 0; line < line_count_; ++line) {
+         ready[line].fd = sockets_[line];
+         ready[line].events = POLLRDNORM;
+     }
+     WSAPoll(ready.data(), static_cast<ULONG>(line_count_), 100);
+#else
+     std::array<pollfd, LineArbiter::MaxLines> ready{};
+     for (size_t line = 0; line < line_count_; ++line) {
+         ready[line].fd = sockets_[line];
+         ready[line].events = POLLIN;
      }
+     poll(ready.data(), static_cast<nfds_t>(line_count_), 100);
+#endif
+ }
+
+ void UDPReceiver::run(RawMessageRing& output_queue) {
+
+     uint32_t idle_spins = 0;
+
+#if defined(__linux__)
+     const size_t batch_size = config_.batch_size;
+
+     std::vector<RawMessage> overflow_buffer(batch_size);
+     ReceiveBatch receive_batch(batch_size);
 
      while (running_.load(std::memory_order_acquire)) {
 
-         const int received = recvmmsg(socket_fd_, msg_vec.data(),
-                                       static_cast<unsigned int>(BatchSize), 0, nullptr);
-         if (received < 0) {
+         bool idle = true;
+         for (size_t line = 0; line < line_count_; ++line) {
+
+             const size_t claimed = output_queue.try_claim_n(batch_size);
+             const size_t batch = claimed == 0 ? batch_size : claimed;
+
+             for (size_t idx = 0; idx < batch; ++idx) {
+                 RawMessage& slot = claimed == 0 ? overflow_buffer[idx] : output_queue.claimed(idx);
+                 receive_batch.target(idx, slot.payload.data());
+             }
+
+             const int received = receive_batch.receive(sockets_[line], batch, recv_flags_);
+             if (received < 0) {
 
-            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
-                 std::this_thread::yield();
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                     continue;
+                }
+                return;
+             }
+             idle = false;
+
+             if (claimed == 0) {
+                 push_failures_.fetch_add(static_cast<uint64_t>(received), std::memory_order_relaxed);
+                 continue;
+             }
+
+             const uint64_t batch_cycles = rdtsc();
+             uint64_t batch_bytes = 0;
+             size_t kept = 0;
+             for (size_t idx = 0; idx < static_cast<size_t>(received); ++idx) {
+                 RawMessage& message_entry = output_queue.claimed(idx);
+                 const size_t len = receive_batch.length(idx);
+                 if (line_count_ > 1 && !arbiter_.accept(line, message_entry.payload.data(), len)) {
+                     continue;
+                 }
+
+                 RawMessage& kept_entry = output_queue.claimed(kept++);
+                 if (&kept_entry != &message_entry) {
+                     std::memcpy(kept_entry.payload.data(), message_entry.payload.data(), len);
+                 }
+                 kept_entry.len = len;
+                 kept_entry.recv_cycles = batch_cycles;
+                 kept_entry.kernel_ns = receive_batch.kernel_ns(idx);
+                 batch_bytes += len;
+             }
+             if (kept == 0) {
                  continue;
-            }
-            break;
+             }
+             output_queue.commit_n(kept);
+             idle_spins = 0;
+             if (doorbell_) {
+                 doorbell_->notify();
+             }
+
+             messages_received_.fetch_add(static_cast<uint64_t>(kept), std::memory_order_relaxed);
+             bytes_received_.fetch_add(batch_bytes, std::memory_order_relaxed);
          }
 
-         for (int idx = 0; idx < received; ++idx) {
-             auto& message_entry = batch_buffer[idx];
-             message_entry.len = static_cast<size_t>(msg_vec[idx].msg_len);
-             message_entry.recv_timestamp_ns = now_ns();
+         if (idle) {
+             wait_for_data(idle_spins);
+         }
+     }
+#else
+
+     RawMessage overflow_message;
+
+     while (running_.load(std::memory_order_acquire)) {
+
+         bool idle = true;
+         for (size_t line = 0; line < line_count_; ++line) {
+
+             RawMessage* slot = output_queue.try_claim();
+             RawMessage& message = slot ? *slot : overflow_message;
 
-             if (!output_queue.try_push(message_entry)) {
+#ifdef _WIN32
+             const int len = recvfrom(sockets_[line], message.payload.data(),
+                                      static_cast<int>(RawMessage::MaxPayload), 0, nullptr, nullptr);
+             if (len == SOCKET_ERROR) {
+                 const int error = WSAGetLastError();
+                if (error == WSAEWOULDBLOCK || error == WSAEINTR || error == WSAECONNRESET) {
+                     continue;
+                }
+                return;
+             }
+             message.len = static_cast<size_t>(len);
+#else
+             const ssize_t len = recvfrom(sockets_[line], message.payload.data(),
+                                          RawMessage::MaxPayload, 0, nullptr, nullptr);
+             if (len < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                     continue;
+                }
+                return;
+             }
+             message.len = static_cast<size_t>(len);
+#endif
+             idle = false;
+
+             message.recv_cycles = rdtsc();
+             message.kernel_ns = 0;
+
+             if (slot == nullptr) {
                  push_failures_.fetch_add(1, std::memory_order_relaxed);
                  continue;
              }
+             if (line_count_ > 1 && !arbiter_.accept(line, message.payload.data(), message.len)) {
+                 continue;
+             }
+             output_queue.commit();
+             idle_spins = 0;
+             if (doorbell_) {
+                 doorbell_->notify();
+             }
 
              messages_received_.fetch_add(1, std::memory_order_relaxed);
-             bytes_received_.fetch_add(message_entry.len, std::memory_order_relaxed);
+             bytes_received_.fetch_add(message.len, std::memory_order_relaxed);
+         }
+
+         if (idle) {
+             wait_for_data(idle_spins);
          }
      }
-#else
+#endif
+ }
 
-     RawMessage message;
+ void UDPReceiver::run(DatagramRing& output_queue) {
+
+     uint32_t idle_spins = 0;
+
+#if defined(__linux__)
+     const size_t batch_size = config_.batch_size;
+
+     std::vector<RawMessage> overflow_buffer(batch_size);
+     std::vector<char*> payloads(batch_size);
+     std::vector<size_t> lengths(batch_size);
+     std::vector<uint64_t> timestamps(batch_size);
+     std::vector<uint64_t> kernel_timestamps(batch_size);
+     ReceiveBatch receive_batch(batch_size);
 
      while (running_.load(std::memory_order_acquire)) {
 
-#ifdef _WIN32
-         const int len = recvfrom(socket_fd_, message.payload.data(),
-                                  static_cast<int>(RawMessage::MaxPayload), 0, nullptr, nullptr);
-         if (len == SOCKET_ERROR) {
-             const int error = WSAGetLastError();
-            if (error == WSAEWOULDBLOCK || error == WSAEINTR || error == WSAECONNRESET) {
-                 std::this_thread::yield();
+         bool idle = true;
+         for (size_t line = 0; line < line_count_; ++line) {
+
+             const size_t reserved = output_queue.reserve_batch(batch_size, RawMessage::MaxPayload, payloads.data());
+             const size_t batch = reserved == 0 ? batch_size : reserved;
+
+             for (size_t idx = 0; idx < batch; ++idx) {
+                 receive_batch.target(idx, reserved == 0 ? overflow_buffer[idx].payload.data() : payloads[idx]);
+             }
+
+             const int received = receive_batch.receive(sockets_[line], batch, recv_flags_);
+             if (received < 0) {
+
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                     continue;
+                }
+                return;
+             }
+             idle = false;
+
+             if (reserved == 0) {
+                 push_failures_.fetch_add(static_cast<uint64_t>(received), std::memory_order_relaxed);
                  continue;
-            }
-            break;
-         }
-         message.len = static_cast<size_t>(len);
-#else
-         const ssize_t len = recvfrom(socket_fd_, message.payload.data(),
-                                      RawMessage::MaxPayload, 0, nullptr, nullptr);
-         if (len < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
-                 std::this_thread::yield();
+             }
+
+             const uint64_t batch_cycles = rdtsc();
+             uint64_t batch_bytes = 0;
+             size_t kept = 0;
+             for (size_t idx = 0; idx < static_cast<size_t>(received); ++idx) {
+                 lengths[idx] = receive_batch.length(idx);
+                 if (line_count_ > 1 && !arbiter_.accept(line, payloads[idx], lengths[idx])) {
+                     lengths[idx] = 0;
+                     continue;
+                 }
+                 timestamps[idx] = batch_cycles;
+                 kernel_timestamps[idx] = receive_batch.kernel_ns(idx);
+                 batch_bytes += lengths[idx];
+                 ++kept;
+             }
+             output_queue.commit_batch(static_cast<size_t>(received), lengths.data(), timestamps.data(),
+                                       kernel_timestamps.data());
+             if (kept == 0) {
                  continue;
-            }
-            break;
+             }
+             idle_spins = 0;
+             if (doorbell_) {
+                 doorbell_->notify();
+             }
+
+             messages_received_.fetch_add(static_cast<uint64_t>(kept), std::memory_order_relaxed);
+             bytes_received_.fetch_add(batch_bytes, std::memory_order_relaxed);
+         }
+
+         if (idle) {
+             wait_for_data(idle_spins);
          }
-         message.len = static_cast<size_t>(len);
+     }
+#else
+
+     RawMessage overflow_message;
+
+     while (running_.load(std::memory_order_acquire)) {
+
+         bool idle = true;
+         for (size_t line = 0; line < line_count_; ++line) {
+
+             char* slot = output_queue.reserve(RawMessage::MaxPayload);
+             char* target = slot ? slot : overflow_message.payload.data();
+
+#ifdef _WIN32
+             const int len = recvfrom(sockets_[line], target,
+                                      static_cast<int>(RawMessage::MaxPayload), 0, nullptr, nullptr);
+             if (len == SOCKET_ERROR) {
+                 const int error = WSAGetLastError();
+                if (error == WSAEWOULDBLOCK || error == WSAEINTR || error == WSAECONNRESET) {
+                     continue;
+                }
+                return;
+             }
+#else
+             const ssize_t len = recvfrom(sockets_[line], target,
+                                          RawMessage::MaxPayload, 0, nullptr, nullptr);
+             if (len < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                     continue;
+                }
+                return;
+             }
 #endif
+             idle = false;
 
-         message.recv_timestamp_ns = now_ns();
+             if (slot == nullptr) {
+                 push_failures_.fetch_add(1, std::memory_order_relaxed);
+                 continue;
+             }
+             if (line_count_ > 1 && !arbiter_.accept(line, target, static_cast<size_t>(len))) {
+                 continue;
+             }
+             output_queue.commit(static_cast<size_t>(len), rdtsc());
+             idle_spins = 0;
+             if (doorbell_) {
+                 doorbell_->notify();
+             }
 
-         if (!output_queue.try_push(message)) {
-             push_failures_.fetch_add(1, std::memory_order_relaxed);
-             continue;
+             messages_received_.fetch_add(1, std::memory_order_relaxed);
+             bytes_received_.fetch_add(static_cast<uint64_t>(len), std::memory_order_relaxed);
          }
 
-         messages_received_.fetch_add(1, std::memory_order_relaxed);
-         bytes_received_.fetch_add(message.len, std::memory_order_relaxed);
+         if (idle) {
+             wait_for_data(idle_spins);
+         }
      }
 #endif
  }
 
- }
\ No newline at end of file
+ }
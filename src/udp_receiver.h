@@ -1,8 +1,13 @@
 #pragma once
 
+#include "byte_ring.h"
+#include "line_arbiter.h"
 #include "market_data.h"
 #include "ring_buffer.h"
+#include "wait_strategy.h"
+#include "utils/cpu.h"
 
+#include <array>
 #include <atomic>
 #include <string>
 #include <thread>
@@ -30,14 +35,30 @@ using socket_handle_t = int;
 constexpr socket_handle_t kInvalidSocket = -1;
 #endif
 
+using RawMessageRing = SPSCRingBuffer<RawMessage, 65536>;
+
+using DatagramRing = ByteRing<(1u << 23)>;
+
+struct ReceiverConfig {
+    size_t batch_size{8};
+    WaitMode wait{WaitMode::Yield};
+    uint32_t spin_limit{20'000};
+    int busy_poll_us{50};
+    ThreadPlacement placement;
+    std::string line_b_ip;
+    uint16_t line_b_port{0};
+};
+
 class UDPReceiver {
 public:
 
-    UDPReceiver(const std::string& multicast_ip, uint16_t port);
+    UDPReceiver(const std::string& multicast_ip, uint16_t port, const ReceiverConfig& config = ReceiverConfig{});
 
     ~UDPReceiver();
 
-    void start(SPSCRingBuffer<RawMessage, 65536>& output_queue);
+    void start(RawMessageRing& output_queue, Doorbell* doorbell = nullptr);
+
+    void start(DatagramRing& output_queue, Doorbell* doorbell = nullptr);
 
     void stop();
 
@@ -47,16 +68,39 @@ public:
 
     uint64_t ring_push_failures() const;
 
+    const std::string& placement() const;
+
+    size_t line_count() const;
+
+    LineStats line_stats(size_t line) const;
+
 private:
 
-    void run(SPSCRingBuffer<RawMessage, 65536>& output_queue);
+    void run(RawMessageRing& output_queue);
 
-    socket_handle_t socket_fd_{kInvalidSocket};
+    void run(DatagramRing& output_queue);
+
+    socket_handle_t open_line(const std::string& multicast_ip, uint16_t port, bool blocking);
+
+    void wait_for_data(uint32_t& idle_spins) const;
+
+    void place_thread();
+
+    void wait_until_placed() const;
+
+    std::array<socket_handle_t, LineArbiter::MaxLines> sockets_{kInvalidSocket, kInvalidSocket};
+    size_t line_count_{1};
+    LineArbiter arbiter_;
     std::string multicast_ip_;
     uint16_t port_{0};
+    ReceiverConfig config_;
+    int recv_flags_{0};
+    Doorbell* doorbell_{nullptr};
 
     std::atomic<bool> running_{false};
     std::thread receiver_thread_;
+    std::string placement_;
+    std::atomic<bool> placed_{false};
 
     std::atomic<uint64_t> messages_received_{0};
     std::atomic<uint64_t> bytes_received_{0};
@@ -64,5 +108,3 @@ private:
 };
 
 }
-
-}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace market {
+
+struct ThreadPlacement {
+    int cpu{-1};
+    int fifo_priority{0};
+};
+
+inline int numa_node_of_cpu(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0) {
+        return -1;
+    }
+    for (int node = 0; node < 1024; ++node) {
+        const std::string path =
+            "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/node" + std::to_string(node);
+        struct stat info{};
+        if (stat(path.c_str(), &info) == 0) {
+            return node;
+        }
+    }
+#else
+    (void)cpu;
+#endif
+    return -1;
+}
+
+inline int current_cpu() {
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+inline std::string apply_thread_placement(const ThreadPlacement& placement) {
+#if defined(__linux__)
+    std::string report;
+
+    if (placement.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(placement.cpu, &set);
+        const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0) {
+            report += "affinity cpu " + std::to_string(placement.cpu) + " failed (" + std::strerror(rc) + "), ";
+        } else {
+            sched_yield();
+        }
+    }
+
+    if (placement.fifo_priority > 0) {
+        sched_param param{};
+        param.sched_priority = placement.fifo_priority;
+        const int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc != 0) {
+            report += "SCHED_FIFO " + std::to_string(placement.fifo_priority) + " failed (" + std::strerror(rc) + "), ";
+        }
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    pthread_getaffinity_np(pthread_self(), sizeof(allowed), &allowed);
+    const int cpu = current_cpu();
+    if (CPU_COUNT(&allowed) == 1) {
+        report += "pinned to cpu " + std::to_string(cpu);
+    } else {
+        report += "unpinned (" + std::to_string(CPU_COUNT(&allowed)) + " cpus, on cpu " + std::to_string(cpu) + ")";
+    }
+
+    const int node = numa_node_of_cpu(cpu);
+    if (node >= 0) {
+        report += ", node " + std::to_string(node);
+    }
+
+    int policy = 0;
+    sched_param param{};
+    pthread_getschedparam(pthread_self(), &policy, &param);
+    report += policy == SCHED_FIFO ? ", SCHED_FIFO " + std::to_string(param.sched_priority) : ", SCHED_OTHER";
+    return report;
+#else
+    (void)placement;
+    return "placement not supported on this platform";
+#endif
+}
+
+class ScopedMemoryPolicy {
+public:
+
+    explicit ScopedMemoryPolicy(int node) {
+#if defined(__linux__)
+        if (node < 0 || node >= static_cast<int>(sizeof(unsigned long) * 8)) {
+            return;
+        }
+        const unsigned long mask = 1UL << node;
+        applied_ = syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, sizeof(mask) * 8) == 0;
+#else
+        (void)node;
+#endif
+    }
+
+    ~ScopedMemoryPolicy() {
+#if defined(__linux__)
+        if (applied_) {
+            syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+        }
+#endif
+    }
+
+    ScopedMemoryPolicy(const ScopedMemoryPolicy&) = delete;
+    ScopedMemoryPolicy& operator=(const ScopedMemoryPolicy&) = delete;
+
+    bool applied() const {
+        return applied_;
+    }
+
+private:
+
+    bool applied_{false};
+};
+
+inline void prefault(void* data, size_t len) {
+#if defined(__linux__)
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+    const size_t page = 4096;
+#endif
+    volatile char* bytes = static_cast<volatile char*>(data);
+    for (size_t offset = 0; offset < len; offset += page) {
+        bytes[offset] = bytes[offset];
+    }
+    if (len > 0) {
+        bytes[len - 1] = bytes[len - 1];
+    }
+}
+
+}
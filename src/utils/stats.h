@@ -21,57 +21,174 @@ struct LatencySnapshot {
     std::array<uint64_t, 5> histogram{};
 };
 
-class LatencyStats {
+class LatencyHistogram {
 public:
 
-    explicit LatencyStats(size_t max_samples = 1'000'000)
-        : max_samples_(max_samples) {
+    explicit LatencyHistogram(uint32_t precision_bits = 7)
+        : bits_(std::clamp<uint32_t>(precision_bits, 2, 16)),
+          half_(size_t{1} << (bits_ - 1)),
+          counts_((size_t{1} << bits_) + (64 - bits_) * half_, 0) {}
+
+    void record(uint64_t value) {
+        ++counts_[index_of(value)];
+        ++total_;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        if (other.bits_ == bits_) {
+            for (size_t idx = 0; idx < counts_.size(); ++idx) {
+                counts_[idx] += other.counts_[idx];
+            }
+            total_ += other.total_;
+            return;
+        }
+
+        for (size_t idx = 0; idx < other.counts_.size(); ++idx) {
+            if (other.counts_[idx] != 0) {
+                counts_[index_of(other.lowest_value(idx))] += other.counts_[idx];
+                total_ += other.counts_[idx];
+            }
+        }
+    }
+
+    uint64_t value_at_percentile(double q) const {
+        if (total_ == 0) {
+            return 0;
+        }
+
+        const double clamped = std::clamp(q, 0.0, 1.0);
+        uint64_t target = static_cast<uint64_t>(clamped * static_cast<double>(total_) + 0.5);
+        target = std::clamp<uint64_t>(target, 1, total_);
+
+        uint64_t seen = 0;
+        for (size_t idx = 0; idx < counts_.size(); ++idx) {
+            seen += counts_[idx];
+            if (seen >= target) {
+                return highest_value(idx);
+            }
+        }
+        return highest_value(counts_.size() - 1);
+    }
+
+    uint64_t count_below(uint64_t value) const {
+        uint64_t count = 0;
+        const size_t end = index_of(value);
+        for (size_t idx = 0; idx < end; ++idx) {
+            count += counts_[idx];
+        }
+        return count;
+    }
+
+    uint64_t total_count() const {
+        return total_;
+    }
+
+    uint32_t precision_bits() const {
+        return bits_;
+    }
+
+    size_t bucket_count() const {
+        return counts_.size();
+    }
+
+    void reset() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        total_ = 0;
+    }
+
+private:
 
-        samples_.reserve(std::min<size_t>(max_samples_, 16'384));
+    static uint32_t highest_bit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#else
+        uint32_t bit = 0;
+        while (value >>= 1) {
+            ++bit;
+        }
+        return bit;
+#endif
     }
 
+    size_t index_of(uint64_t value) const {
+        const uint64_t linear = uint64_t{1} << bits_;
+        if (value < linear) {
+            return static_cast<size_t>(value);
+        }
+
+        const uint32_t exponent = highest_bit(value) - bits_ + 1;
+        const size_t mantissa = static_cast<size_t>(value >> exponent);
+        return static_cast<size_t>(linear) + (exponent - 1) * half_ + (mantissa - half_);
+    }
+
+    uint64_t lowest_value(size_t idx) const {
+        const size_t linear = size_t{1} << bits_;
+        if (idx < linear) {
+            return idx;
+        }
+
+        const size_t offset = idx - linear;
+        const uint32_t exponent = static_cast<uint32_t>(offset / half_) + 1;
+        const uint64_t mantissa = offset % half_ + half_;
+        return mantissa << exponent;
+    }
+
+    uint64_t highest_value(size_t idx) const {
+        const size_t linear = size_t{1} << bits_;
+        if (idx < linear) {
+            return idx;
+        }
+
+        const uint32_t exponent = static_cast<uint32_t>((idx - linear) / half_) + 1;
+        return lowest_value(idx) + ((uint64_t{1} << exponent) - 1);
+    }
+
+    uint32_t bits_;
+    size_t half_;
+    std::vector<uint64_t> counts_;
+    uint64_t total_{0};
+};
+
+class LatencyStats {
+public:
+
+    explicit LatencyStats(uint32_t precision_bits = 7)
+        : histogram_(precision_bits) {}
+
     void record(uint64_t latency_ns) {
 
         total_latency_ns_ += latency_ns;
-        total_samples_ += 1;
         min_ns_ = std::min(min_ns_, latency_ns);
         max_ns_ = std::max(max_ns_, latency_ns);
 
-        if (samples_.size() < max_samples_) {
-            samples_.push_back(latency_ns);
-        } else {
-            samples_[next_index_] = latency_ns;
-        }
-        next_index_ = (next_index_ + 1) % max_samples_;
+        histogram_.record(latency_ns);
+    }
 
-        bucket_for(latency_ns);
+    void merge(const LatencyStats& other) {
+        total_latency_ns_ += other.total_latency_ns_;
+        min_ns_ = std::min(min_ns_, other.min_ns_);
+        max_ns_ = std::max(max_ns_, other.max_ns_);
+        histogram_.merge(other.histogram_);
     }
 
-    LatencySnapshot snapshot() const {
+    LatencySnapshot snapshot(double ns_per_unit = 1.0) const {
         LatencySnapshot snap;
-        const size_t recorded = std::min(total_samples_, max_samples_);
+        const uint64_t recorded = histogram_.total_count();
         if (recorded == 0) {
             return snap;
         }
 
-        snap.sample_count = recorded;
-        snap.avg_ns = total_latency_ns_ / total_samples_;
-        snap.min_ns = min_ns_;
-        snap.max_ns = max_ns_;
-        snap.histogram = bucket_counts_;
-
-        std::vector<uint64_t> sorted;
-        sorted.reserve(recorded);
-
-        const size_t available = std::min(samples_.size(), recorded);
-        sorted.insert(sorted.end(), samples_.begin(), samples_.begin() + available);
+        auto to_ns = [&](uint64_t value) {
+            return static_cast<uint64_t>(static_cast<double>(value) * ns_per_unit);
+        };
 
-        std::sort(sorted.begin(), sorted.end());
+        snap.sample_count = recorded;
+        snap.avg_ns = to_ns(total_latency_ns_ / recorded);
+        snap.min_ns = to_ns(min_ns_);
+        snap.max_ns = to_ns(max_ns_);
 
         auto percentile = [&](double q) {
-
-            const size_t idx = std::min<size_t>(static_cast<size_t>(q * sorted.size()), sorted.size() - 1);
-            return sorted[idx];
+            return to_ns(std::min(histogram_.value_at_percentile(q), max_ns_));
         };
 
         snap.p50_ns = percentile(0.50);
@@ -79,43 +196,40 @@ public:
         snap.p99_ns = percentile(0.99);
         snap.p999_ns = percentile(0.999);
 
+        uint64_t below = 0;
+        for (size_t idx = 0; idx < bucket_bounds_.size(); ++idx) {
+            const auto bound = static_cast<uint64_t>(static_cast<double>(bucket_bounds_[idx]) / ns_per_unit);
+            const uint64_t upto = histogram_.count_below(bound);
+            snap.histogram[idx] = upto - below;
+            below = upto;
+        }
+        snap.histogram.back() = recorded - below;
+
         return snap;
     }
 
+    uint64_t value_at_percentile(double q) const {
+        return std::min(histogram_.value_at_percentile(q), max_ns_);
+    }
+
     void reset() {
-        samples_.clear();
-        next_index_ = 0;
+        histogram_.reset();
         total_latency_ns_ = 0;
-        total_samples_ = 0;
         min_ns_ = std::numeric_limits<uint64_t>::max();
         max_ns_ = 0;
-        bucket_counts_.fill(0);
     }
 
-    size_t max_samples() const {
-        return max_samples_;
+    const LatencyHistogram& histogram() const {
+        return histogram_;
     }
 
 private:
-    size_t max_samples_;
-    std::vector<uint64_t> samples_;
-    size_t next_index_{0};
+    LatencyHistogram histogram_;
     uint64_t total_latency_ns_{0};
-    uint64_t total_samples_{0};
     uint64_t min_ns_{std::numeric_limits<uint64_t>::max()};
     uint64_t max_ns_{0};
-    std::array<uint64_t, 5> bucket_counts_{};
-
-    const std::array<uint64_t, 4> bucket_bounds_{500, 1000, 2000, 5000};
 
-    void bucket_for(uint64_t latency_ns) {
-        size_t idx = 0;
-
-        while (idx < bucket_bounds_.size() && latency_ns >= bucket_bounds_[idx]) {
-            ++idx;
-        }
-        ++bucket_counts_[idx];
-    }
+    static constexpr std::array<uint64_t, 4> bucket_bounds_{500, 1000, 2000, 5000};
 };
 
 }
@@ -3,6 +3,10 @@
 #include <chrono>
 #include <cstdint>
 
+#if defined(__x86_64__) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
 namespace market {
 
 inline uint64_t now_ns() {
@@ -11,6 +15,12 @@ inline uint64_t now_ns() {
     return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
 }
 
+inline uint64_t realtime_ns() {
+
+    const auto now = std::chrono::system_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+}
+
 #if defined(__x86_64__) && !defined(_MSC_VER)
 
 inline uint64_t rdtsc() {
@@ -19,11 +29,53 @@ inline uint64_t rdtsc() {
     __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
     return (static_cast<uint64_t>(hi) << 32) | lo;
 }
+
+inline uint64_t rdtsc_fenced() {
+    unsigned int lo, hi;
+
+    __asm__ __volatile__("lfence\n\trdtsc" : "=a"(lo), "=d"(hi) : : "memory");
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+inline uint64_t rdtscp(uint32_t* cpu = nullptr) {
+    unsigned int lo, hi, aux;
+
+    __asm__ __volatile__("rdtscp\n\tlfence" : "=a"(lo), "=d"(hi), "=c"(aux) : : "memory");
+    if (cpu) {
+        *cpu = aux;
+    }
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+inline bool invariant_tsc() {
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007) {
+        return false;
+    }
+
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;
+}
 #else
 
 inline uint64_t rdtsc() {
     return now_ns();
 }
+
+inline uint64_t rdtsc_fenced() {
+    return now_ns();
+}
+
+inline uint64_t rdtscp(uint32_t* cpu = nullptr) {
+    if (cpu) {
+        *cpu = 0;
+    }
+    return now_ns();
+}
+
+inline bool invariant_tsc() {
+    return true;
+}
 #endif
 
 }
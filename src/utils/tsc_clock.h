@@ -0,0 +1,131 @@
+#pragma once
+
+#include "timestamp.h"
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace market {
+
+class TscClock {
+public:
+
+    struct Sample {
+        uint64_t cycles{0};
+        uint64_t ns{0};
+    };
+
+    void calibrate(std::chrono::milliseconds window = std::chrono::milliseconds(50)) {
+        invariant_ = invariant_tsc();
+
+        origin_ = sample();
+        std::this_thread::sleep_for(window);
+        anchor_ = sample();
+        update_ratio();
+        realtime_offset_ns_ = realtime_offset();
+    }
+
+    void recalibrate() {
+        anchor_ = sample();
+        update_ratio();
+        realtime_offset_ns_ = realtime_offset();
+        ++recalibrations_;
+    }
+
+    static uint64_t now_cycles() {
+        return rdtsc();
+    }
+
+    uint64_t to_ns(uint64_t cycles) const {
+        return static_cast<uint64_t>(static_cast<double>(cycles) * ns_per_cycle_);
+    }
+
+    uint64_t to_monotonic_ns(uint64_t cycles) const {
+        const double delta = static_cast<double>(static_cast<int64_t>(cycles - anchor_.cycles)) * ns_per_cycle_;
+        return anchor_.ns + static_cast<int64_t>(delta);
+    }
+
+    uint64_t to_realtime_ns(uint64_t cycles) const {
+        return to_monotonic_ns(cycles) + realtime_offset_ns_;
+    }
+
+    uint64_t cycles_at_realtime(uint64_t realtime_ns) const {
+        const auto monotonic = static_cast<int64_t>(realtime_ns - realtime_offset_ns_ - anchor_.ns);
+        return anchor_.cycles + static_cast<int64_t>(static_cast<double>(monotonic) / ns_per_cycle_);
+    }
+
+    uint64_t cycles_for_ns(uint64_t ns) const {
+        return static_cast<uint64_t>(static_cast<double>(ns) / ns_per_cycle_);
+    }
+
+    double ns_per_cycle() const {
+        return ns_per_cycle_;
+    }
+
+    double ghz() const {
+        return 1.0 / ns_per_cycle_;
+    }
+
+    bool invariant() const {
+        return invariant_;
+    }
+
+    uint64_t recalibrations() const {
+        return recalibrations_;
+    }
+
+private:
+
+    static Sample sample() {
+        Sample best;
+        uint64_t best_window = ~0ULL;
+
+        for (int attempt = 0; attempt < 8; ++attempt) {
+            const uint64_t before = now_ns();
+            const uint64_t cycles = rdtsc_fenced();
+            const uint64_t after = now_ns();
+
+            if (after - before < best_window) {
+                best_window = after - before;
+                best.cycles = cycles;
+                best.ns = before + (after - before) / 2;
+            }
+        }
+        return best;
+    }
+
+    static uint64_t realtime_offset() {
+        uint64_t best = 0;
+        uint64_t best_window = ~0ULL;
+
+        for (int attempt = 0; attempt < 8; ++attempt) {
+            const uint64_t before = now_ns();
+            const uint64_t realtime = realtime_ns();
+            const uint64_t after = now_ns();
+
+            if (after - before < best_window) {
+                best_window = after - before;
+                best = realtime - (before + (after - before) / 2);
+            }
+        }
+        return best;
+    }
+
+    void update_ratio() {
+        const uint64_t cycles = anchor_.cycles - origin_.cycles;
+        const uint64_t ns = anchor_.ns - origin_.ns;
+        if (cycles > 0 && ns > 0) {
+            ns_per_cycle_ = static_cast<double>(ns) / static_cast<double>(cycles);
+        }
+    }
+
+    Sample origin_;
+    Sample anchor_;
+    uint64_t realtime_offset_ns_{0};
+    double ns_per_cycle_{1.0};
+    bool invariant_{false};
+    uint64_t recalibrations_{0};
+};
+
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace market {
+
+enum class WaitMode : uint8_t {
+    Yield,
+    Spin,
+    BusyPoll,
+    Backoff,
+    Block,
+};
+
+inline const char* wait_mode_name(WaitMode mode) {
+    switch (mode) {
+        case WaitMode::Yield:
+            return "yield";
+        case WaitMode::Spin:
+            return "spin";
+        case WaitMode::BusyPoll:
+            return "busy-poll";
+        case WaitMode::Backoff:
+            return "backoff";
+        case WaitMode::Block:
+            return "block";
+    }
+    return "unknown";
+}
+
+inline bool parse_wait_mode(const std::string& name, WaitMode& mode) {
+    for (const WaitMode candidate : {WaitMode::Yield, WaitMode::Spin, WaitMode::BusyPoll,
+                                     WaitMode::Backoff, WaitMode::Block}) {
+        if (name == wait_mode_name(candidate)) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(_MSC_VER)
+    _mm_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+class Doorbell {
+public:
+
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+
+        sequence_.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sequence_), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+    }
+
+    template <typename Ready>
+    void wait(Ready&& ready, std::chrono::microseconds timeout) {
+        const uint32_t seen = sequence_.load(std::memory_order_acquire);
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!ready()) {
+#if defined(__linux__)
+            timespec ts{};
+            ts.tv_sec = static_cast<time_t>(timeout.count() / 1'000'000);
+            ts.tv_nsec = static_cast<long>((timeout.count() % 1'000'000) * 1'000);
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sequence_), FUTEX_WAIT_PRIVATE, seen, &ts, nullptr, 0);
+#else
+            (void)seen;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+#endif
+        }
+
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain uint32_t");
+
+    alignas(64) std::atomic<uint32_t> sequence_{0};
+    std::atomic<uint32_t> waiters_{0};
+};
+
+class IdleWaiter {
+public:
+
+    IdleWaiter(WaitMode mode, Doorbell* doorbell, uint32_t spin_limit)
+        : mode_(mode), doorbell_(doorbell), spin_limit_(spin_limit) {}
+
+    template <typename Ready>
+    void idle(Ready&& ready) {
+        switch (mode_) {
+            case WaitMode::Spin:
+            case WaitMode::BusyPoll:
+                cpu_relax();
+                return;
+
+            case WaitMode::Backoff:
+                if (spins_ < spin_limit_) {
+                    ++spins_;
+                    cpu_relax();
+                    return;
+                }
+                break;
+
+            case WaitMode::Block:
+                break;
+
+            case WaitMode::Yield:
+            default:
+                std::this_thread::yield();
+                return;
+        }
+
+        if (doorbell_ == nullptr) {
+            std::this_thread::yield();
+            return;
+        }
+        doorbell_->wait(ready, std::chrono::milliseconds(100));
+    }
+
+    void reset() {
+        spins_ = 0;
+    }
+
+    bool needs_doorbell() const {
+        return mode_ == WaitMode::Backoff || mode_ == WaitMode::Block;
+    }
+
+private:
+
+    WaitMode mode_;
+    Doorbell* doorbell_;
+    uint32_t spin_limit_;
+    uint32_t spins_{0};
+};
+
+}
@@ -0,0 +1,115 @@
+#include "../src/bbo_table.h"
+#include "../src/book_manager.h"
+#include "../src/market_data.h"
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+
+int main() {
+    market::BboTable table(2000);
+    market::BookManager books(4, 2000);
+    books.publish_bbo(&table);
+
+    market::Bbo bbo;
+    assert(!table.read(1000, bbo));
+    assert(!table.read(5000, bbo));
+
+    market::OrderAdd add{};
+    add.header.msg_type = market::MSG_ORDER_ADD;
+    add.header.msg_len = static_cast<uint16_t>(sizeof(market::OrderAdd));
+    add.header.sequence_num = 7;
+    add.header.timestamp_ns = 1'000;
+    add.order_id = 1;
+    add.symbol_id = 1000;
+    add.price = 1'000'000;
+    add.size = 100;
+    add.side = 'B';
+    books.on_order_add(add);
+
+    assert(table.read(1000, bbo));
+    assert(bbo.symbol_id == 1000 && bbo.sequence_num == 7 && bbo.timestamp_ns == 1'000);
+    assert(bbo.top.bid_price == 1'000'000 && bbo.top.bid_size == 100);
+    assert(bbo.top.ask_price == 0 && bbo.top.ask_size == 0);
+
+    add.header.sequence_num = 8;
+    add.order_id = 2;
+    books.on_order_add(add);
+    assert(table.read(1000, bbo) && bbo.top.bid_size == 200 && bbo.sequence_num == 8);
+
+    const uint32_t version = table.version(1000);
+    add.header.sequence_num = 9;
+    add.order_id = 3;
+    add.price = 999'900;
+    books.on_order_add(add);
+    assert(table.version(1000) == version);
+
+    add.header.sequence_num = 10;
+    add.order_id = 4;
+    add.price = 1'000'200;
+    add.side = 'S';
+    books.on_order_add(add);
+    assert(table.read(1000, bbo) && bbo.sequence_num == 10);
+    assert(bbo.top.ask_price == 1'000'200 && bbo.top.ask_size == 100 && bbo.top.bid_size == 200);
+
+    market::OrderExecute execute{};
+    execute.header.msg_type = market::MSG_ORDER_EXECUTE;
+    execute.header.sequence_num = 11;
+    execute.order_id = 1;
+    execute.symbol_id = 1000;
+    execute.executed_size = 40;
+    books.on_order_execute(execute);
+    assert(table.read(1000, bbo) && bbo.top.bid_size == 160 && bbo.sequence_num == 11);
+
+    market::BookReset reset{};
+    reset.header.msg_type = market::MSG_BOOK_RESET;
+    reset.header.sequence_num = 12;
+    reset.symbol_id = 1000;
+    books.on_book_reset(reset);
+    assert(table.read(1000, bbo) && bbo.sequence_num == 12);
+    assert(bbo.top == market::BookTop{});
+
+    assert(!table.read(1001, bbo));
+
+    market::BboTable shared(16);
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> observed{0};
+    std::thread reader([&]() {
+        market::Bbo seen;
+        uint32_t last_sequence = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            if (!shared.read(3, seen)) {
+                continue;
+            }
+            assert(seen.symbol_id == 3);
+            assert(seen.sequence_num >= last_sequence);
+            assert(seen.top.bid_size == seen.sequence_num && seen.top.ask_size == seen.sequence_num + 1);
+            assert(seen.top.ask_price - seen.top.bid_price == 5);
+            assert(seen.timestamp_ns == static_cast<uint64_t>(seen.sequence_num) * 1'000);
+            last_sequence = seen.sequence_num;
+            observed.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    constexpr uint32_t kUpdates = 2'000'000;
+    uint32_t seq = 0;
+    while (++seq <= kUpdates || observed.load(std::memory_order_relaxed) < 100'000) {
+        market::Bbo update;
+        update.symbol_id = 3;
+        update.sequence_num = seq;
+        update.timestamp_ns = static_cast<uint64_t>(seq) * 1'000;
+        update.top.bid_price = 1'000 + seq % 89;
+        update.top.ask_price = update.top.bid_price + 5;
+        update.top.bid_size = seq;
+        update.top.ask_size = seq + 1;
+        shared.publish(update);
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    assert(shared.read(3, bbo) && bbo.sequence_num == seq - 1);
+
+    std::cout << "test_bbo_table: OK (" << observed.load() << " concurrent reads)\n";
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "../src/capture.h"
+#include "../src/replay.h"
+#include "../src/utils/timestamp.h"
+#include "../src/utils/tsc_clock.h"
+
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main() {
+    namespace fs = std::filesystem;
+
+    const fs::path dir = fs::temp_directory_path() / "test_capture_journal";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const std::string path = (dir / "feed.mdcap").string();
+
+    market::TscClock clock;
+    clock.calibrate(std::chrono::milliseconds(5));
+
+    market::CaptureConfig config;
+    config.path = path;
+    config.rotate_bytes = 256 * 1024;
+    config.kernel_timestamps = true;
+    config.block_bytes = 16 * 1024;
+
+    std::array<char, 1000> payload{};
+    uint64_t accepted = 0;
+    auto send = [&](market::CaptureJournal& journal) {
+        std::memcpy(payload.data(), &accepted, sizeof(accepted));
+        const size_t len = 100 + accepted % 900;
+        if (journal.record(payload.data(), len, market::rdtsc(), 1'000 + accepted)) {
+            ++accepted;
+            return true;
+        }
+        return false;
+    };
+
+    {
+        market::CaptureJournal journal(config, clock);
+
+        while (send(journal)) {
+        }
+        assert(journal.stats().dropped == 1);
+        assert(accepted > 10'000);
+
+        journal.start();
+        for (int idx = 0; idx < 5'000; ++idx) {
+            while (!send(journal)) {
+                std::this_thread::yield();
+            }
+        }
+        journal.stop();
+
+        const market::CaptureStats stats = journal.stats();
+        assert(stats.records == accepted);
+        assert(stats.files > 1);
+    }
+
+    uint64_t expected = 0;
+    uint64_t last_recv = 0;
+    uint32_t files = 0;
+    for (uint32_t index = 0; fs::exists(market::CaptureJournal::file_name(path, index)); ++index) {
+        const std::string name = market::CaptureJournal::file_name(path, index);
+        assert(fs::file_size(name) <= config.rotate_bytes);
+
+        std::ifstream in(name, std::ios::binary);
+        const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        market::CaptureFileHeader header{};
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        assert(header.magic == market::kCaptureMagic);
+        assert(header.version == market::kCaptureVersion);
+        assert(header.flags == market::kCaptureKernelTimestamps);
+        assert(header.file_index == index);
+
+        size_t offset = sizeof(header);
+        while (offset < bytes.size()) {
+            market::CaptureRecordHeader record{};
+            uint64_t kernel_ns = 0;
+            uint64_t sequence = 0;
+            std::memcpy(&record, bytes.data() + offset, sizeof(record));
+            std::memcpy(&kernel_ns, bytes.data() + offset + sizeof(record), sizeof(kernel_ns));
+            std::memcpy(&sequence, bytes.data() + offset + sizeof(record) + sizeof(kernel_ns), sizeof(sequence));
+
+            assert(sequence == expected);
+            assert(record.len == 100 + expected % 900);
+            assert(kernel_ns == 1'000 + expected);
+            assert(record.recv_ns + 1'000'000 >= last_recv);
+            last_recv = record.recv_ns;
+
+            offset += sizeof(record) + sizeof(kernel_ns) + record.len;
+            ++expected;
+        }
+        assert(offset == bytes.size());
+        ++files;
+    }
+    assert(expected == accepted);
+    assert(files > 1);
+
+    market::CaptureReader reader(path);
+    assert(reader.files() == files);
+    market::ReplayRecord record;
+    uint64_t replayed = 0;
+    while (reader.next(record)) {
+        uint64_t sequence = 0;
+        std::memcpy(&sequence, record.data, sizeof(sequence));
+        assert(sequence == replayed);
+        assert(record.len == 100 + replayed % 900);
+        assert(record.kernel_ns == 1'000 + replayed);
+        ++replayed;
+    }
+    assert(replayed == accepted);
+    assert(reader.truncated() == 0);
+
+    market::ReplayPacer paced(2.0);
+    const uint64_t begin = market::now_ns();
+    paced.wait(1'000'000'000);
+    paced.wait(1'020'000'000);
+    assert(market::now_ns() - begin >= 10'000'000);
+
+    market::ReplayPacer unpaced(0.0);
+    const uint64_t fast = market::now_ns();
+    unpaced.wait(1);
+    unpaced.wait(10'000'000'000ULL);
+    assert(market::now_ns() - fast < 5'000'000);
+
+    fs::remove_all(dir);
+    std::cout << "test_capture: OK (" << accepted << " records in " << files << " files)\n";
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "../src/book_manager.h"
+#include "../src/market_data.h"
+#include "../src/message_handler.h"
+#include "../src/message_parser.h"
+#include "../src/trade_analytics.h"
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+class Recorder : public market::MessageHandler<Recorder> {
+public:
+
+    Recorder(std::vector<std::string>& log, const char* name)
+        : log_(log), name_(name) {}
+
+    void on_header(const market::MessageHeader&) {
+        ++headers;
+    }
+
+    void on_quote(const market::Quote&) {
+        log_.push_back(name_ + ":quote");
+    }
+
+    void on_order_add(const market::OrderAdd&) {
+        log_.push_back(name_ + ":add");
+    }
+
+    uint64_t headers{0};
+
+private:
+
+    std::vector<std::string>& log_;
+    std::string name_;
+};
+
+}
+
+int main() {
+    using Books = market::BookManager<market::OrderBook<market::TickLadder, market::FlatOrderIndex>>;
+    using Chain = market::HandlerChain<Recorder, market::TradeAnalytics, Books>;
+    static_assert(!std::is_polymorphic<Chain>::value, "handler chains must not need a vtable");
+    static_assert(!std::is_polymorphic<Books>::value && !std::is_polymorphic<market::TradeAnalytics>::value,
+                  "handlers must not need a vtable");
+
+    market::RawMessage packet{};
+    uint32_t sequence = 1;
+    auto append = [&](auto message, uint16_t type) {
+        message.header.msg_type = type;
+        message.header.msg_len = static_cast<uint16_t>(sizeof(message));
+        message.header.sequence_num = sequence++;
+        std::memcpy(packet.payload.data() + packet.len, &message, sizeof(message));
+        packet.len += sizeof(message);
+    };
+
+    market::OrderAdd add{};
+    add.order_id = 1;
+    add.symbol_id = 1000;
+    add.price = 1'000'000;
+    add.size = 100;
+    add.side = 'B';
+    append(add, market::MSG_ORDER_ADD);
+
+    market::Trade trade{};
+    trade.symbol_id = 1000;
+    trade.price = 1'000'000;
+    trade.size = 30;
+    trade.side = 'S';
+    append(trade, market::MSG_TRADE);
+
+    market::Quote quote{};
+    quote.symbol_id = 1001;
+    quote.bid_price = 500'000;
+    quote.ask_price = 500'100;
+    quote.bid_size = 10;
+    quote.ask_size = 20;
+    append(quote, market::MSG_QUOTE);
+
+    market::OrderExecute execute{};
+    execute.order_id = 1;
+    execute.symbol_id = 1000;
+    execute.executed_size = 30;
+    append(execute, market::MSG_ORDER_EXECUTE);
+
+    std::vector<std::string> log;
+    Recorder first(log, "first");
+    Recorder last(log, "last");
+    market::TradeAnalytics trades(4, 2000);
+    Books books(4, 2000);
+    Chain chain(first, trades, books);
+    market::HandlerChain<Chain, Recorder> nested(chain, last);
+
+    market::MessageParser parser;
+    assert(parser.parse_packet(packet, nested) == 4);
+
+    assert((log == std::vector<std::string>{"first:add", "last:add", "first:quote", "last:quote"}));
+    assert(first.headers == 4 && last.headers == 4);
+
+    assert(books.best_bid(1000) == 1'000'000);
+    assert(books.find(1000)->orders().find(1)->size == 70);
+    assert(books.best_ask(1001) == 500'100);
+
+    market::TradeSnapshot snap;
+    assert(trades.snapshot(1000, snap) && snap.trades == 1 && snap.volume == 30 && snap.sell_volume == 30);
+    assert(!trades.snapshot(1001, snap));
+
+    market::MessageHeader unknown{};
+    unknown.msg_type = 99;
+    first.on_message(&unknown);
+    assert(first.headers == 5 && log.size() == 4);
+
+    std::cout << "test_message_handler: OK\n";
+    return 0;
+}
@@ -1,8 +1,12 @@
+#include "../src/book_manager.h"
 #include "../src/order_book.h"
 #include "../src/market_data.h"
 
 #include <cassert>
 #include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
 
 int main() {
     market::OrderBook book;
@@ -30,6 +34,216 @@ int main() {
     book.on_order_cancel(cancel);
     assert(book.best_bid() == 0);
 
+    market::BookManager books(4, 2000);
+    assert(books.register_symbol(1001) == 0);
+
+    add.symbol_id = 1000;
+    add.price = 1'000'100;
+    books.on_order_add(add);
+
+    add.order_id = 11;
+    add.symbol_id = 1001;
+    add.price = 990'000;
+    books.on_order_add(add);
+
+    assert(books.best_bid(1000) == 1'000'100);
+    assert(books.best_bid(1001) == 990'000);
+    assert(books.best_bid(1002) == 0);
+    assert(books.slot_of(1000) == 1);
+    assert(books.symbol_at(1) == 1000);
+    assert(books.active_symbols() == 2);
+
+    cancel.order_id = 10;
+    cancel.symbol_id = 1000;
+    books.on_order_cancel(cancel);
+    assert(books.best_bid(1000) == 0);
+    assert(books.best_bid(1001) == 990'000);
+
+    add.symbol_id = 5000;
+    books.on_order_add(add);
+    assert(books.unrouted_messages() == 1);
+
+    add.symbol_id = 1002;
+    books.on_order_add(add);
+    add.symbol_id = 1003;
+    books.on_order_add(add);
+    add.symbol_id = 1004;
+    books.on_order_add(add);
+    assert(books.active_symbols() == 4);
+    assert(books.unrouted_messages() == 2);
+    assert(books.register_symbol(1004) == market::BookManager<>::kNoSlot);
+
+    market::BookConfig narrow;
+    narrow.ladder_levels = 64;
+
+    market::OrderBook<market::TickLadder> ladder(narrow);
+    add.symbol_id = 55;
+    add.order_id = 20;
+    add.price = 1'000;
+    ladder.on_order_add(add);
+    add.order_id = 21;
+    add.price = 1'500;
+    ladder.on_order_add(add);
+    assert(ladder.best_bid() == 1'500);
+    assert(ladder.levels().recenters() >= 2);
+
+    cancel.order_id = 21;
+    ladder.on_order_cancel(cancel);
+    assert(ladder.best_bid() == 1'000);
+
+    auto level_size = [](const auto& book, char side, int64_t price) {
+        uint32_t found = 0;
+        book.levels().for_each_level(side, 64, [&](int64_t level, uint32_t size) {
+            if (level == price) {
+                found = size;
+            }
+        });
+        return found;
+    };
+
+    market::OrderBook<market::TickLadder, market::FlatOrderIndex> amended;
+    market::OrderAdd resting = add;
+    resting.symbol_id = 55;
+    resting.order_id = 30;
+    resting.price = 2'000;
+    resting.size = 500;
+    resting.side = 'S';
+    amended.on_order_add(resting);
+    resting.order_id = 31;
+    resting.size = 200;
+    amended.on_order_add(resting);
+
+    market::OrderExecute execute{};
+    execute.header.msg_type = market::MSG_ORDER_EXECUTE;
+    execute.symbol_id = 55;
+    execute.order_id = 30;
+    execute.executed_size = 100;
+    amended.on_order_execute(execute);
+    assert(amended.orders().find(30)->size == 400);
+    assert(level_size(amended, 'S', 2'000) == 600);
+
+    market::OrderModify modify{};
+    modify.header.msg_type = market::MSG_ORDER_MODIFY;
+    modify.symbol_id = 55;
+    modify.order_id = 30;
+    modify.size = 300;
+    amended.on_order_modify(modify);
+    assert(amended.orders().find(30)->size == 300);
+    assert(level_size(amended, 'S', 2'000) == 500);
+
+    modify.size = 900;
+    amended.on_order_modify(modify);
+    assert(amended.rejected_orders() == 1);
+    assert(amended.orders().find(30)->size == 300);
+
+    market::OrderReplace replace{};
+    replace.header.msg_type = market::MSG_ORDER_REPLACE;
+    replace.symbol_id = 55;
+    replace.order_id = 31;
+    replace.new_order_id = 32;
+    replace.price = 1'990;
+    replace.size = 700;
+    amended.on_order_replace(replace);
+    assert(amended.orders().find(31) == nullptr);
+    assert(amended.orders().find(32)->side == 'S');
+    assert(amended.best_ask() == 1'990);
+    assert(level_size(amended, 'S', 2'000) == 300);
+    assert(level_size(amended, 'S', 1'990) == 700);
+
+    execute.order_id = 32;
+    execute.executed_size = 700;
+    amended.on_order_execute(execute);
+    assert(amended.orders().find(32) == nullptr);
+    assert(amended.best_ask() == 2'000);
+
+    modify.order_id = 30;
+    modify.size = 0;
+    amended.on_order_modify(modify);
+    assert(amended.orders().size() == 0);
+    assert(amended.best_ask() == 0);
+
+    market::MapLevels reference;
+    market::TickLadder candidate(narrow);
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int64_t> price_dist(900, 1'100);
+    std::uniform_int_distribution<uint32_t> size_dist(0, 300);
+    std::uniform_int_distribution<int> op_dist(0, 2);
+
+    for (int i = 0; i < 200'000; ++i) {
+        const char side = (i & 1) ? 'B' : 'S';
+        const int64_t price = price_dist(rng);
+        const uint32_t size = size_dist(rng);
+
+        switch (op_dist(rng)) {
+            case 0:
+                reference.add(side, price, size);
+                candidate.add(side, price, size);
+                break;
+            case 1:
+                reference.reduce(side, price, size);
+                candidate.reduce(side, price, size);
+                break;
+            default:
+                reference.set(side, price, size);
+                candidate.set(side, price, size);
+                break;
+        }
+
+        assert(reference.best_bid() == candidate.best_bid());
+        assert(reference.best_ask() == candidate.best_ask());
+    }
+
+    for (const char side : {'B', 'S'}) {
+        std::vector<int64_t> expected;
+        std::vector<int64_t> actual;
+        reference.for_each_level(side, 100, [&](int64_t price, uint32_t size) { expected.push_back(price * 1'000 + size); });
+        candidate.for_each_level(side, 100, [&](int64_t price, uint32_t size) { actual.push_back(price * 1'000 + size); });
+        assert(expected == actual);
+    }
+
+    market::FlatOrderIndex index(1'000);
+    std::unordered_map<uint64_t, uint32_t> mirror;
+    std::uniform_int_distribution<uint64_t> id_dist(1, 2'000);
+
+    for (int i = 0; i < 200'000; ++i) {
+        const uint64_t id = id_dist(rng);
+        if (op_dist(rng) == 0) {
+            assert(index.erase(id) == (mirror.erase(id) == 1));
+        } else if (index.insert(market::Order{id, 1, 0, static_cast<uint32_t>(i), 'B'})) {
+            mirror[id] = static_cast<uint32_t>(i);
+        } else {
+            assert(mirror.size() == index.capacity() && mirror.count(id) == 0);
+        }
+
+        assert(index.size() == mirror.size());
+        const market::Order* found = index.find(id);
+        assert((found != nullptr) == (mirror.count(id) == 1));
+        assert(found == nullptr || found->size == mirror[id]);
+    }
+    assert(index.longest_probe() < market::FlatOrderIndex::kMaxProbe);
+
+    market::OrderBook<market::TickLadder, market::FlatOrderIndex> flat_book(narrow);
+    market::BookConfig tiny;
+    tiny.order_capacity = 1;
+    market::OrderBook<market::TickLadder, market::FlatOrderIndex> full_book(tiny);
+
+    add.order_id = 30;
+    add.price = 2'000;
+    flat_book.on_order_add(add);
+    full_book.on_order_add(add);
+    add.order_id = 31;
+    add.price = 2'001;
+    flat_book.on_order_add(add);
+    full_book.on_order_add(add);
+    assert(flat_book.best_bid() == 2'001);
+    assert(full_book.best_bid() == 2'000);
+    assert(full_book.rejected_orders() == 1);
+
+    cancel.order_id = 31;
+    flat_book.on_order_cancel(cancel);
+    assert(flat_book.best_bid() == 2'000);
+    assert(flat_book.orders().size() == 1);
+
     std::cout << "test_order_book: OK\n";
     return 0;
 }
@@ -1,8 +1,11 @@
+#include "../src/line_arbiter.h"
 #include "../src/message_parser.h"
 #include "../src/market_data.h"
 
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 int main() {
     market::MessageParser parser;
@@ -21,6 +24,156 @@ int main() {
     assert(parser.parse(raw) == nullptr);
     assert(parser.invalid_messages() == 1);
 
+    market::MessageParser packet_parser;
+    market::RawMessage packet{};
+    uint32_t sequence = 10;
+    auto append = [&](auto message, uint16_t type) {
+        message.header.msg_type = type;
+        message.header.msg_len = static_cast<uint16_t>(sizeof(message));
+        message.header.sequence_num = sequence++;
+        std::memcpy(packet.payload.data() + packet.len, &message, sizeof(message));
+        packet.len += sizeof(message);
+    };
+    append(market::Quote{}, market::MSG_QUOTE);
+    append(market::OrderAdd{}, market::MSG_ORDER_ADD);
+    append(market::OrderCancel{}, market::MSG_ORDER_CANCEL);
+    append(market::Trade{}, market::MSG_TRADE);
+
+    std::vector<uint16_t> types;
+    const size_t delivered = packet_parser.parse_packet(packet, [&](const market::MessageHeader* h) {
+        types.push_back(h->msg_type);
+    });
+    assert(delivered == 4);
+    assert((types == std::vector<uint16_t>{market::MSG_QUOTE, market::MSG_ORDER_ADD,
+                                           market::MSG_ORDER_CANCEL, market::MSG_TRADE}));
+    assert(packet_parser.sequence_gaps() == 0 && packet_parser.invalid_messages() == 0);
+
+    types.clear();
+    packet.len = 0;
+    append(market::OrderExecute{}, market::MSG_ORDER_EXECUTE);
+    append(market::OrderModify{}, market::MSG_ORDER_MODIFY);
+    append(market::OrderReplace{}, market::MSG_ORDER_REPLACE);
+    assert(packet_parser.parse_packet(packet, [&](const market::MessageHeader* h) {
+        types.push_back(h->msg_type);
+    }) == 3);
+    assert((types == std::vector<uint16_t>{market::MSG_ORDER_EXECUTE, market::MSG_ORDER_MODIFY,
+                                           market::MSG_ORDER_REPLACE}));
+    assert(market::MessageParser::expected_len(market::MSG_ORDER_REPLACE) == sizeof(market::OrderReplace));
+
+    sequence += 5;
+    packet.len = 0;
+    append(market::Quote{}, market::MSG_QUOTE);
+    append(market::Trade{}, market::MSG_TRADE);
+    packet.len += 3;
+    assert(packet_parser.parse_packet(packet, [](const market::MessageHeader*) {}) == 2);
+    assert(packet_parser.sequence_gaps() == 5);
+    assert(packet_parser.invalid_messages() == 1);
+
+    packet.len = 0;
+    append(market::Quote{}, market::MSG_QUOTE);
+    append(market::Trade{}, market::MSG_TRADE);
+    reinterpret_cast<market::MessageHeader*>(packet.payload.data())->msg_type = 99;
+    reinterpret_cast<market::MessageHeader*>(packet.payload.data() + sizeof(market::Quote))->msg_len = 4;
+    assert(packet_parser.parse_packet(packet, [](const market::MessageHeader*) {}) == 0);
+    assert(packet_parser.invalid_messages() == 3);
+    assert(packet_parser.packets() == 4);
+
+    market::LineArbiter arbiter(8);
+    auto offer = [&](size_t line, uint32_t first, uint32_t count) {
+        packet.len = 0;
+        sequence = first;
+        for (uint32_t idx = 0; idx < count; ++idx) {
+            append(market::Quote{}, market::MSG_QUOTE);
+        }
+        return arbiter.accept(line, packet.payload.data(), packet.len);
+    };
+    assert(offer(0, 1, 2));
+    assert(!offer(1, 1, 2));
+    assert(offer(0, 5, 2));
+    assert(offer(1, 3, 2));
+    assert(!offer(0, 3, 2));
+    assert(!offer(1, 5, 2));
+    assert(offer(0, 258, 1));
+    assert(offer(1, 600, 1));
+    assert(!offer(0, 300, 1));
+    assert(offer(0, 1, 1));
+
+    const market::LineStats line_a = arbiter.stats(0);
+    const market::LineStats line_b = arbiter.stats(1);
+    assert(line_a.datagrams == 6 && line_a.won == 4 && line_a.duplicates == 2);
+    assert(line_a.lost == 2 + 251 + 41);
+    assert(line_b.datagrams == 4 && line_b.won == 2 && line_b.duplicates == 2);
+    assert(line_b.lost == 593);
+
+    market::MessageParser backwards;
+    market::RawMessage single{};
+    auto send_single = [&](market::MessageParser& target, uint32_t sequence_num, std::vector<uint32_t>& order) {
+        market::Quote quote{};
+        quote.header.msg_type = market::MSG_QUOTE;
+        quote.header.msg_len = static_cast<uint16_t>(sizeof(quote));
+        quote.header.sequence_num = sequence_num;
+        std::memcpy(single.payload.data(), &quote, sizeof(quote));
+        single.len = sizeof(quote);
+        return target.parse_packet(single, [&](const market::MessageHeader* h) { order.push_back(h->sequence_num); });
+    };
+    std::vector<uint32_t> order;
+    send_single(backwards, 100, order);
+    assert(send_single(backwards, 90, order) == 0);
+    assert(backwards.sequence_gaps() == 0 && backwards.duplicate_messages() == 1);
+
+    market::ReorderConfig reorder_config;
+    reorder_config.window = 8;
+    reorder_config.timeout_messages = 3;
+    reorder_config.timeout_ns = 1'000'000'000ULL;
+    market::MessageParser reorder(reorder_config);
+    order.clear();
+
+    send_single(reorder, 1, order);
+    assert(send_single(reorder, 3, order) == 0);
+    assert(send_single(reorder, 4, order) == 0 && reorder.held_messages() == 2);
+    assert(send_single(reorder, 2, order) == 3);
+    assert(send_single(reorder, 3, order) == 0 && reorder.duplicate_messages() == 1);
+    assert(reorder.reordered_messages() == 2 && reorder.sequence_gaps() == 0);
+
+    send_single(reorder, 6, order);
+    send_single(reorder, 7, order);
+    send_single(reorder, 8, order);
+    assert(send_single(reorder, 9, order) == 4);
+    assert(reorder.sequence_gaps() == 1 && reorder.gap_timeouts() == 1 && reorder.held_messages() == 0);
+    assert(send_single(reorder, 5, order) == 0 && reorder.duplicate_messages() == 2);
+
+    send_single(reorder, 10, order);
+    assert(send_single(reorder, 20, order) == 0);
+    assert(reorder.sequence_gaps() == 3);
+    packet.len = 0;
+    sequence = 13;
+    for (uint32_t seq = 13; seq < 20; ++seq) {
+        append(market::Quote{}, market::MSG_QUOTE);
+    }
+    assert(reorder.parse_packet(packet, [&](const market::MessageHeader* h) { order.push_back(h->sequence_num); }) == 8);
+    assert(reorder.held_messages() == 0 && reorder.sequence_gaps() == 3);
+
+    std::vector<uint32_t> expected_order{1, 2, 3, 4, 6, 7, 8, 9, 10};
+    for (uint32_t seq = 13; seq <= 20; ++seq) {
+        expected_order.push_back(seq);
+    }
+    assert(order == expected_order);
+
+    assert(send_single(reorder, 22, order) == 0 && reorder.held_messages() == 1);
+    const uint32_t far = 22 + 1'000'000'000;
+    assert(send_single(reorder, far, order) == 1 && order.back() == 22);
+    assert(reorder.held_messages() == 1 && reorder.sequence_gaps() == 3 + (far - 21) - 8);
+
+    reorder_config.timeout_ns = 0;
+    market::MessageParser immediate(reorder_config);
+    packet.len = 0;
+    sequence = 31;
+    append(market::Quote{}, market::MSG_QUOTE);
+    sequence = 33;
+    append(market::Quote{}, market::MSG_QUOTE);
+    assert(immediate.parse_packet(packet, [](const market::MessageHeader*) {}) == 2);
+    assert(immediate.sequence_gaps() == 1 && immediate.held_messages() == 0);
+
     std::cout << "test_parser: OK\n";
     return 0;
 }
@@ -0,0 +1,132 @@
+#include "../tools/feed_generator.h"
+#include "../tools/recovery_server.h"
+#include "../src/book_manager.h"
+#include "../src/market_data.h"
+#include "../src/message_parser.h"
+#include "../src/recovery.h"
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+int main() {
+    constexpr uint32_t kSymbols = 40;
+    constexpr uint32_t kMessages = 120'000;
+    constexpr uint32_t kLossyMessages = 100'000;
+    constexpr uint32_t kPack = 4;
+
+    market::BookConfig config;
+    config.order_capacity = 8192;
+
+    using Candidate = market::OrderBook<market::TickLadder, market::FlatOrderIndex>;
+    using Reference = market::OrderBook<market::MapLevels, market::StdOrderIndex>;
+    market::BookManager<Candidate> books(kSymbols, 1000 + kSymbols, config);
+    market::BookManager<Reference> reference(kSymbols, 1000 + kSymbols, config);
+
+    feed::FeedGenerator generator(kSymbols);
+    feed::RecoveryServer server(kSymbols, 0);
+
+    market::ReorderConfig reorder;
+    reorder.window = 64;
+    reorder.timeout_messages = 32;
+    market::MessageParser parser(reorder);
+
+    market::RecoveryConfig recovery_config;
+    recovery_config.port = server.port();
+    recovery_config.buffer_messages = 8192;
+    recovery_config.retry_ms = 1;
+    market::RecoveryCoordinator recovery(recovery_config);
+
+    auto sink = [&](const market::MessageHeader* header) { books.on_message(header); };
+    auto deliver = [&](const market::MessageHeader* header) { recovery.on_message(header, sink); };
+
+    std::mt19937_64 drop_rng(7);
+    std::uniform_real_distribution<double> drop_dist(0.0, 1.0);
+    std::array<char, 256> packet{};
+    size_t packet_len = 0;
+    uint32_t packed = 0;
+    uint32_t dropped = 0;
+    uint32_t max_stale = 0;
+
+    for (uint32_t idx = 0; idx < kMessages; ++idx) {
+        const market::MessageHeader* message = generator.next();
+        server.apply(message);
+        reference.on_message(message);
+
+        std::memcpy(packet.data() + packet_len, message, message->msg_len);
+        packet_len += message->msg_len;
+        if (++packed < kPack) {
+            continue;
+        }
+
+        if (idx < kLossyMessages && drop_dist(drop_rng) < 0.002) {
+            ++dropped;
+        } else {
+            parser.parse_packet(packet.data(), packet_len, deliver);
+        }
+        packet_len = 0;
+        packed = 0;
+
+        recovery.poll(sink);
+        if (recovery.recovering()) {
+            max_stale = std::max(max_stale, books.stale_books());
+            std::this_thread::yield();
+        }
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (recovery.recovering() && std::chrono::steady_clock::now() < deadline) {
+        recovery.poll(sink);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    assert(dropped > 0);
+    assert(!recovery.recovering());
+    assert(recovery.recoveries() > 0);
+    assert(recovery.snapshots_applied() == recovery.recoveries());
+    assert(server.snapshots_served() >= recovery.snapshots_applied());
+    assert(max_stale > 0);
+    assert(books.stale_books() == 0);
+
+    for (uint32_t symbol = 1000; symbol < 1000 + kSymbols; ++symbol) {
+        const Candidate* book = books.find(symbol);
+        const Reference* expected = reference.find(symbol);
+        assert(book != nullptr && expected != nullptr);
+        assert(book->orders().size() == expected->orders().size());
+        assert(book->rejected_orders() == 0);
+
+        for (const char side : {'B', 'S'}) {
+            std::vector<std::pair<int64_t, uint32_t>> actual;
+            std::vector<std::pair<int64_t, uint32_t>> wanted;
+            book->levels().for_each_level(side, 1 << 20, [&](int64_t price, uint32_t size) {
+                actual.emplace_back(price, size);
+            });
+            expected->levels().for_each_level(side, 1 << 20, [&](int64_t price, uint32_t size) {
+                wanted.emplace_back(price, size);
+            });
+            assert(actual == wanted);
+        }
+    }
+
+    market::BookReset reset{};
+    reset.header.msg_type = market::MSG_BOOK_RESET;
+    reset.header.msg_len = sizeof(reset);
+    reset.symbol_id = market::kAllSymbols;
+    books.on_message(&reset.header);
+    assert(books.stale_books() == kSymbols);
+    assert(books.best_bid(1000) == reference.best_bid(1000));
+    reset.symbol_id = 1000;
+    books.on_message(&reset.header);
+    assert(books.stale_books() == kSymbols - 1);
+    assert(!books.is_stale(1000) && books.is_stale(1001));
+    assert(books.best_bid(1000) == 0 && books.find(1000)->orders().size() == 0);
+
+    std::cout << "test_recovery: OK (" << dropped << " packets dropped, " << recovery.recoveries()
+              << " recoveries, " << recovery.replayed_messages() << " messages replayed)\n";
+    return 0;
+}
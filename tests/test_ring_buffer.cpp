@@ -1,6 +1,8 @@
+#include "../src/byte_ring.h"
 #include "../src/ring_buffer.h"
 
 #include <cassert>
+#include <cstring>
 #include <iostream>
 
 int main() {
@@ -18,6 +20,117 @@ int main() {
     }
     assert(!buffer.try_pop(value));
 
+    assert(buffer.try_claim_n(16) == 7);
+    for (int i = 0; i < 3; ++i) {
+        buffer.claimed(static_cast<size_t>(i)) = 10 + i;
+    }
+    assert(buffer.size() == 0);
+    buffer.commit_n(3);
+    assert(buffer.size() == 3);
+
+    int* slot = buffer.try_claim();
+    assert(slot != nullptr);
+    *slot = 13;
+    buffer.commit();
+
+    for (int i = 0; i < 4; ++i) {
+        const int* front = buffer.peek();
+        assert(front != nullptr && *front == 10 + i);
+        buffer.release();
+    }
+    assert(buffer.peek() == nullptr);
+
+    for (int i = 0; i < 7; ++i) {
+        assert(buffer.try_claim() != nullptr);
+        buffer.commit();
+    }
+    assert(buffer.try_claim() == nullptr);
+    assert(buffer.try_claim_n(4) == 0);
+
+    market::SPSCRingBuffer<int, 8> batched;
+    const int inputs[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int outputs[10] = {};
+    assert(batched.try_push_n(inputs, 10) == 7);
+    assert(batched.try_pop_n(outputs, 3) == 3);
+    assert(outputs[0] == 0 && outputs[2] == 2);
+    assert(batched.try_push_n(inputs + 7, 3) == 3);
+    assert(batched.try_pop_n(outputs, 10) == 7);
+    for (int i = 0; i < 7; ++i) {
+        assert(outputs[i] == i + 3);
+    }
+    assert(batched.try_pop_n(outputs, 10) == 0);
+
+    market::ByteRing<256> bytes;
+    market::ByteRecord record;
+    assert(!bytes.peek(record));
+    assert(bytes.reserve(200) == nullptr);
+
+    uint32_t produced = 0;
+    uint32_t consumed = 0;
+    for (int round = 0; round < 1'000; ++round) {
+        const size_t len = 1 + static_cast<size_t>(round % 37);
+        char* payload = bytes.reserve(len);
+        if (payload != nullptr) {
+            std::memset(payload, static_cast<int>(produced & 0x7F), len);
+            bytes.commit(len, produced);
+            ++produced;
+        }
+
+        if (round % 3 == 0 || payload == nullptr) {
+            while (bytes.peek(record)) {
+                assert(record.recv_cycles == consumed);
+                assert(reinterpret_cast<uintptr_t>(record.data) % 8 == 0);
+                for (uint32_t idx = 0; idx < record.len; ++idx) {
+                    assert(record.data[idx] == static_cast<char>(consumed & 0x7F));
+                }
+                bytes.release();
+                ++consumed;
+            }
+        }
+    }
+    assert(produced > 500);
+
+    while (bytes.peek(record)) {
+        bytes.release();
+        ++consumed;
+    }
+    assert(consumed == produced);
+    assert(bytes.size() == 0);
+
+    char* payloads[4] = {};
+    const size_t granted = bytes.reserve_batch(4, 16, payloads);
+    assert(granted == 3);
+    const size_t lengths[3] = {5, 16, 1};
+    const uint64_t stamps[3] = {100, 101, 102};
+    const uint64_t kernel_stamps[3] = {7, 8, 9};
+    for (size_t idx = 0; idx < granted; ++idx) {
+        std::memset(payloads[idx], 'a' + static_cast<int>(idx), lengths[idx]);
+    }
+    bytes.commit_batch(granted, lengths, stamps, kernel_stamps);
+
+    for (size_t idx = 0; idx < granted; ++idx) {
+        assert(bytes.peek(record));
+        assert(record.len == lengths[idx] && record.recv_cycles == stamps[idx]);
+        assert(record.kernel_ns == kernel_stamps[idx]);
+        assert(record.data[0] == 'a' + static_cast<int>(idx) && record.data[record.len - 1] == record.data[0]);
+        bytes.release();
+    }
+    assert(!bytes.peek(record));
+
+    const size_t kept_lengths[3] = {4, 0, 6};
+    assert(bytes.reserve_batch(3, 16, payloads) == 3);
+    std::memset(payloads[2], 'z', kept_lengths[2]);
+    bytes.commit_batch(3, kept_lengths, stamps);
+    assert(bytes.peek(record) && record.len == 4);
+    bytes.release();
+    assert(bytes.peek(record) && record.len == 6 && record.data[0] == 'z');
+    bytes.release();
+
+    const size_t dropped_lengths[2] = {0, 0};
+    assert(bytes.reserve_batch(2, 16, payloads) == 2);
+    bytes.commit_batch(2, dropped_lengths, stamps);
+    assert(bytes.size() == 0 && !bytes.peek(record));
+
     std::cout << "test_ring_buffer: OK\n";
     return 0;
 }
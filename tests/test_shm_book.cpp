@@ -0,0 +1,132 @@
+#include "../src/book_manager.h"
+#include "../src/market_data.h"
+#include "../src/shm_book.h"
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+int main() {
+    const std::string name = "/mdh_test_books_" + std::to_string(getpid());
+
+    bool threw = false;
+    try {
+        market::ShmBookReader missing(name);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    threw = false;
+    try {
+        market::ShmBookPublisher too_deep(name, 10, market::kShmMaxDepth + 1);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+
+    auto publisher = std::make_unique<market::ShmBookPublisher>(name, 2000, 3);
+    market::BookManager books(4, 2000);
+    books.publish_shm(publisher.get());
+
+    const market::ShmBookReader reader(name);
+    assert(reader.header().depth == 3 && reader.header().symbol_count == 2001);
+    assert(reader.header().writer_pid == static_cast<uint64_t>(getpid()));
+    assert(!reader.writer_closed());
+
+    market::ShmBook book;
+    assert(!reader.read(1000, book));
+    assert(!reader.read(9000, book));
+
+    market::OrderAdd add{};
+    add.header.msg_type = market::MSG_ORDER_ADD;
+    add.header.msg_len = static_cast<uint16_t>(sizeof(market::OrderAdd));
+    add.symbol_id = 1000;
+    add.size = 100;
+    for (uint64_t idx = 0; idx < 5; ++idx) {
+        add.header.sequence_num = static_cast<uint32_t>(idx + 1);
+        add.order_id = idx + 1;
+        add.price = 1'000'000 - static_cast<int64_t>(idx) * 100;
+        add.side = 'B';
+        books.on_order_add(add);
+    }
+    add.header.sequence_num = 6;
+    add.order_id = 6;
+    add.price = 1'000'500;
+    add.side = 'S';
+    books.on_order_add(add);
+
+    assert(reader.read(1000, book));
+    assert(book.symbol_id == 1000 && book.sequence_num == 6);
+    assert(book.bid_levels == 3 && book.ask_levels == 1);
+    assert(book.bids[0].price == 1'000'000 && book.bids[2].price == 999'800 && book.bids[2].size == 100);
+    assert(book.bids[3].price == 0);
+    assert(book.asks[0].price == 1'000'500 && book.asks[0].size == 100);
+
+    const uint32_t version = reader.version(1000);
+    market::OrderCancel cancel{};
+    cancel.header.msg_type = market::MSG_ORDER_CANCEL;
+    cancel.header.sequence_num = 7;
+    cancel.order_id = 5;
+    cancel.symbol_id = 1000;
+    books.on_order_cancel(cancel);
+    assert(reader.version(1000) == version);
+
+    market::OrderModify modify{};
+    modify.header.msg_type = market::MSG_ORDER_MODIFY;
+    modify.header.sequence_num = 8;
+    modify.order_id = 2;
+    modify.symbol_id = 1000;
+    modify.size = 40;
+    books.on_order_modify(modify);
+    assert(reader.version(1000) != version);
+    assert(reader.read(1000, book) && book.sequence_num == 8 && book.bids[1].size == 40);
+
+    cancel.header.sequence_num = 9;
+    cancel.order_id = 3;
+    books.on_order_cancel(cancel);
+    assert(reader.read(1000, book) && book.sequence_num == 9 && book.bid_levels == 3);
+    assert(book.bids[2].price == 999'700 && book.bids[2].size == 100);
+
+    market::BookReset reset{};
+    reset.header.msg_type = market::MSG_BOOK_RESET;
+    reset.header.sequence_num = 10;
+    reset.symbol_id = market::kAllSymbols;
+    books.on_book_reset(reset);
+    assert(reader.read(1000, book) && book.stale != 0 && book.sequence_num == 9);
+    assert(book.bid_levels == 3 && book.bids[0].price == 1'000'000);
+
+    reset.header.sequence_num = 11;
+    reset.symbol_id = 1000;
+    books.on_book_reset(reset);
+    assert(reader.read(1000, book) && book.stale == 0 && book.bid_levels == 0 && book.ask_levels == 0);
+
+    add.header.sequence_num = 12;
+    add.order_id = 7;
+    add.price = 1'000'000;
+    add.side = 'B';
+    books.on_order_add(add);
+    assert(reader.read(1000, book) && book.stale == 0 && book.sequence_num == 12 && book.bid_levels == 1);
+
+    publisher->heartbeat(12'345);
+    assert(reader.heartbeat_ns() == 12'345);
+
+    publisher.reset();
+    assert(reader.writer_closed());
+    assert(reader.read(1000, book) && book.bids[0].price == 1'000'000);
+
+    threw = false;
+    try {
+        market::ShmBookReader unlinked(name);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "test_shm_book: OK\n";
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "../src/utils/stats.h"
+#include "../src/utils/tsc_clock.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+int main() {
+    market::LatencyStats stats;
+    for (uint64_t value = 1; value <= 10'000; ++value) {
+        stats.record(value);
+    }
+
+    const auto snap = stats.snapshot();
+    assert(snap.sample_count == 10'000);
+    assert(snap.min_ns == 1 && snap.max_ns == 10'000);
+    assert(snap.avg_ns == 5'000);
+
+    auto within = [](uint64_t actual, uint64_t expected) {
+        const uint64_t diff = actual > expected ? actual - expected : expected - actual;
+        return diff * 64 <= expected;
+    };
+    assert(within(snap.p50_ns, 5'000));
+    assert(within(snap.p99_ns, 9'900));
+    assert(within(snap.p999_ns, 9'990));
+    assert(stats.value_at_percentile(1.0) == 10'000);
+
+    assert(snap.histogram[0] == 499);
+    assert(snap.histogram[1] == 500);
+    assert(snap.histogram[2] == 1'000);
+    uint64_t total = 0;
+    for (const uint64_t count : snap.histogram) {
+        total += count;
+    }
+    assert(total == 10'000);
+
+    market::LatencyStats small;
+    for (uint64_t value = 0; value < 100; ++value) {
+        small.record(value);
+    }
+    assert(small.snapshot().p50_ns == 49);
+
+    market::LatencyStats other;
+    other.record(1'000'000'000);
+    stats.merge(other);
+    assert(stats.snapshot().sample_count == 10'001);
+    assert(stats.snapshot().max_ns == 1'000'000'000);
+
+    market::LatencyHistogram coarse(4);
+    coarse.record(1'000);
+    market::LatencyHistogram fine(10);
+    fine.merge(coarse);
+    assert(fine.total_count() == 1);
+    assert(fine.value_at_percentile(0.5) >= 896 && fine.value_at_percentile(0.5) <= 1'023);
+
+    market::LatencyHistogram wide;
+    wide.record(UINT64_MAX);
+    assert(wide.value_at_percentile(1.0) == UINT64_MAX);
+
+    stats.reset();
+    assert(stats.snapshot().sample_count == 0);
+
+    market::LatencyStats cycles;
+    for (uint64_t value = 1; value <= 1'000; ++value) {
+        cycles.record(value * 4);
+    }
+    const auto scaled = cycles.snapshot(0.25);
+    assert(scaled.min_ns == 1 && scaled.max_ns == 1'000);
+    assert(within(scaled.p50_ns, 500));
+    assert(scaled.histogram[0] == 499 && scaled.histogram[1] == 500);
+
+    market::TscClock clock;
+    clock.calibrate(std::chrono::milliseconds(20));
+    assert(clock.ns_per_cycle() > 0.0);
+
+    const uint64_t begin_cycles = market::rdtsc_fenced();
+    const uint64_t begin_ns = market::now_ns();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const uint64_t end_cycles = market::rdtscp();
+    const uint64_t measured = clock.to_ns(end_cycles - begin_cycles);
+    const uint64_t reference = market::now_ns() - begin_ns;
+    assert(measured * 10 >= reference * 9 && measured * 10 <= reference * 11);
+
+    clock.recalibrate();
+    assert(clock.recalibrations() == 1);
+    const uint64_t monotonic = clock.to_monotonic_ns(market::rdtsc());
+    const uint64_t now = market::now_ns();
+    assert((monotonic > now ? monotonic - now : now - monotonic) < 1'000'000);
+
+    const uint64_t wall_cycles = clock.cycles_at_realtime(market::realtime_ns());
+    const uint64_t tsc_now = market::rdtsc();
+    const uint64_t skew = wall_cycles > tsc_now ? wall_cycles - tsc_now : tsc_now - wall_cycles;
+    assert(clock.to_ns(skew) < 1'000'000);
+
+    std::cout << "test_stats: OK\n";
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "../src/trade_analytics.h"
+#include "../src/market_data.h"
+
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+market::Trade make_trade(uint32_t symbol, uint64_t timestamp_ns, int64_t price, uint32_t size, char side) {
+    market::Trade trade{};
+    trade.header.msg_type = market::MSG_TRADE;
+    trade.header.msg_len = static_cast<uint16_t>(sizeof(market::Trade));
+    trade.header.timestamp_ns = timestamp_ns;
+    trade.symbol_id = symbol;
+    trade.price = price;
+    trade.size = size;
+    trade.side = side;
+    return trade;
+}
+
+}
+
+int main() {
+    market::TradeAnalyticsConfig config;
+    config.bar_ns = 1'000'000;
+    config.bar_history = 4;
+
+    market::TradeAnalytics analytics(2, 2000, config);
+
+    market::TradeSnapshot snap;
+    assert(!analytics.snapshot(1000, snap));
+
+    analytics.on_trade(make_trade(1000, 5'100'000, 1'000'000, 100, 'B'));
+    analytics.on_trade(make_trade(1000, 5'200'000, 1'000'400, 300, 'S'));
+    analytics.on_trade(make_trade(1000, 5'900'000, 999'800, 100, 'B'));
+
+    assert(analytics.snapshot(1000, snap));
+    assert(snap.symbol_id == 1000);
+    assert(snap.trades == 3);
+    assert(snap.volume == 500);
+    assert(snap.buy_volume == 200 && snap.sell_volume == 300);
+    assert(snap.last_price == 999'800 && snap.last_size == 100 && snap.last_ns == 5'900'000);
+    assert(std::abs(snap.vwap() - (1'000'000.0 * 100 + 1'000'400.0 * 300 + 999'800.0 * 100) / 500) < 1e-6);
+    assert(snap.bar.start_ns == 5'000'000);
+    assert(snap.bar.open == 1'000'000 && snap.bar.high == 1'000'400);
+    assert(snap.bar.low == 999'800 && snap.bar.close == 999'800);
+    assert(snap.bar.volume == 500 && snap.bar.trades == 3);
+
+    market::OhlcvBar bar;
+    assert(!analytics.bar(1000, 0, bar));
+
+    analytics.on_trade(make_trade(1000, 4'500'000, 1'000'100, 100, 'B'));
+    assert(analytics.snapshot(1000, snap) && snap.bar.trades == 4 && snap.bar.start_ns == 5'000'000);
+
+    for (uint64_t idx = 1; idx <= 10; ++idx) {
+        analytics.on_trade(make_trade(1000, 5'000'000 + idx * 1'000'000, 1'000'000 + static_cast<int64_t>(idx), 10, 'S'));
+    }
+    assert(analytics.snapshot(1000, snap));
+    assert(snap.bar.start_ns == 15'000'000 && snap.bar.trades == 1);
+
+    assert(analytics.bar(1000, 0, bar));
+    assert(bar.start_ns == 14'000'000 && bar.open == 1'000'009 && bar.volume == 10);
+    assert(analytics.bar(1000, 3, bar));
+    assert(bar.start_ns == 11'000'000);
+    assert(!analytics.bar(1000, 4, bar));
+
+    analytics.on_trade(make_trade(1001, 1'000, 500'000, 100, 'B'));
+    analytics.on_trade(make_trade(1002, 1'000, 500'000, 100, 'B'));
+    analytics.on_trade(make_trade(5000, 1'000, 500'000, 100, 'B'));
+    assert(analytics.active_symbols() == 2);
+    assert(analytics.unrouted_trades() == 2);
+    assert(!analytics.snapshot(1002, snap));
+
+    market::TradeAnalytics shared(1, 100);
+    std::atomic<bool> done{false};
+    uint64_t observed = 0;
+    std::thread reader([&]() {
+        market::TradeSnapshot seen;
+        uint64_t last_trades = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            if (!shared.snapshot(7, seen)) {
+                continue;
+            }
+            assert(seen.trades >= last_trades);
+            assert(seen.volume == seen.trades * 100);
+            assert(seen.buy_volume + seen.sell_volume == seen.volume);
+            assert(seen.trades == 0 || seen.last_price == 1'000 + static_cast<int64_t>(seen.trades % 97));
+            last_trades = seen.trades;
+            ++observed;
+        }
+    });
+
+    constexpr uint64_t kTrades = 2'000'000;
+    for (uint64_t idx = 1; idx <= kTrades; ++idx) {
+        shared.on_trade(make_trade(7, idx * 1'000, 1'000 + static_cast<int64_t>(idx % 97), 100, idx % 3 == 0 ? 'S' : 'B'));
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    assert(shared.snapshot(7, snap) && snap.trades == kTrades);
+
+    std::cout << "test_trade_analytics: OK (" << observed << " concurrent snapshots)\n";
+    return 0;
+}
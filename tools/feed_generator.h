@@ -0,0 +1,267 @@
+#pragma once
+
+#include "../src/market_data.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace feed {
+
+struct FeedModel {
+    uint32_t symbol_count{100};
+    uint32_t first_symbol{1000};
+    double zipf_exponent{1.0};
+    uint32_t target_depth{100};
+    uint32_t partition{0};
+    uint32_t partitions{1};
+};
+
+class FeedGenerator {
+public:
+
+    explicit FeedGenerator(const FeedModel& model, uint64_t seed = 42)
+        : model_(model), rng_(seed + model.partition), next_order_id_(model.partition + 1) {
+
+        std::vector<double> weights;
+        double total = 0.0;
+        for (uint32_t rank = 0; rank < model.symbol_count; ++rank) {
+            total += 1.0 / std::pow(static_cast<double>(rank + 1), model.zipf_exponent);
+        }
+        for (uint32_t rank = model.partition; rank < model.symbol_count; rank += std::max<uint32_t>(1, model.partitions)) {
+            SymbolState state;
+            state.symbol_id = model.first_symbol + rank;
+            state.anchor = 1'500'000 + static_cast<int64_t>(rank % 64) * 1'000;
+            state.mid = state.anchor;
+            state.live.reserve(model.target_depth * 2);
+            symbols_.push_back(std::move(state));
+            weights.push_back(1.0 / std::pow(static_cast<double>(rank + 1), model.zipf_exponent));
+            share_ += weights.back() / total;
+        }
+        build_alias_table(weights);
+    }
+
+    explicit FeedGenerator(uint32_t symbol_count, uint64_t seed = 42)
+        : FeedGenerator(FeedModel{symbol_count}, seed) {}
+
+    market::MessageHeader* next() {
+        return next(sequence_++);
+    }
+
+    market::MessageHeader* next(uint32_t sequence) {
+
+        SymbolState& state = symbols_[pick_symbol()];
+        const uint64_t bits = rng_();
+        const double action = unit(bits);
+        const bool buy = (bits & 1) != 0;
+        const uint32_t size = lot(bits);
+
+        if (action < kTradeShare) {
+            auto& trade = emit<market::Trade>(market::MSG_TRADE, sequence);
+            const bool lifted = unit(rng_()) < uptick_probability(state);
+            state.mid += lifted ? 1 : -1;
+            trade.symbol_id = state.symbol_id;
+            trade.price = state.mid;
+            trade.size = size;
+            trade.side = lifted ? 'B' : 'S';
+        } else if (action < kTradeShare + kQuoteShare) {
+            auto& quote = emit<market::Quote>(market::MSG_QUOTE, sequence);
+            quote.symbol_id = state.symbol_id;
+            quote.bid_price = state.mid - kHalfSpread;
+            quote.ask_price = state.mid + kHalfSpread;
+            quote.bid_size = size;
+            quote.ask_size = lot(bits >> 8);
+        } else if (!state.live.empty() && unit(rng_()) < cancel_probability(state)) {
+            const uint64_t pick = rng_();
+            const size_t idx = static_cast<size_t>(pick % state.live.size());
+            RestingOrder& order = state.live[idx];
+            const uint32_t kind = static_cast<uint32_t>(pick >> 32 & 0xFF);
+            const uint32_t lots = order.size / 100;
+            const uint32_t partial = lots > 1 ? 100 * (1 + static_cast<uint32_t>(pick >> 40) % (lots - 1)) : 0;
+
+            if (kind < kExecuteShare) {
+                auto& execute = emit<market::OrderExecute>(market::MSG_ORDER_EXECUTE, sequence);
+                execute.order_id = order.order_id;
+                execute.symbol_id = state.symbol_id;
+                execute.executed_size = (pick >> 63) != 0 && partial != 0 ? partial : order.size;
+                order.size -= execute.executed_size;
+            } else if (kind < kExecuteShare + kModifyShare && partial != 0) {
+                auto& modify = emit<market::OrderModify>(market::MSG_ORDER_MODIFY, sequence);
+                order.size -= partial;
+                modify.order_id = order.order_id;
+                modify.symbol_id = state.symbol_id;
+                modify.size = order.size;
+            } else {
+                auto& cancel = emit<market::OrderCancel>(market::MSG_ORDER_CANCEL, sequence);
+                cancel.order_id = order.order_id;
+                cancel.symbol_id = state.symbol_id;
+                order.size = 0;
+            }
+
+            if (order.size == 0) {
+                state.live[idx] = state.live.back();
+                state.live.pop_back();
+            }
+        } else if (!state.live.empty() && unit(rng_()) < kReplaceShare) {
+            auto& replace = emit<market::OrderReplace>(market::MSG_ORDER_REPLACE, sequence);
+            RestingOrder& order = state.live[static_cast<size_t>((bits >> 1) % state.live.size())];
+            const int64_t offset = kHalfSpread + depth(bits);
+            replace.order_id = order.order_id;
+            replace.new_order_id = next_order_id();
+            replace.symbol_id = state.symbol_id;
+            replace.price = order.buy ? state.mid - offset : state.mid + offset;
+            replace.size = size;
+            order.order_id = replace.new_order_id;
+            order.size = size;
+        } else {
+            auto& add = emit<market::OrderAdd>(market::MSG_ORDER_ADD, sequence);
+            const int64_t offset = kHalfSpread + depth(bits);
+            add.order_id = next_order_id();
+            add.symbol_id = state.symbol_id;
+            add.price = buy ? state.mid - offset : state.mid + offset;
+            add.size = size;
+            add.side = buy ? 'B' : 'S';
+            state.live.push_back(RestingOrder{add.order_id, size, buy});
+        }
+
+        return reinterpret_cast<market::MessageHeader*>(buffer_.data());
+    }
+
+    size_t live_orders() const {
+        size_t total = 0;
+        for (const SymbolState& state : symbols_) {
+            total += state.live.size();
+        }
+        return total;
+    }
+
+    size_t symbols() const {
+        return symbols_.size();
+    }
+
+    double share() const {
+        return share_;
+    }
+
+private:
+
+    static constexpr double kTradeShare = 0.06;
+    static constexpr double kQuoteShare = 0.10;
+    static constexpr int64_t kHalfSpread = 12;
+    static constexpr uint32_t kExecuteShare = 64;
+    static constexpr uint32_t kModifyShare = 38;
+    static constexpr double kReplaceShare = 0.10;
+
+    struct AliasEntry {
+        double threshold{1.0};
+        uint32_t alias{0};
+    };
+
+    struct RestingOrder {
+        uint64_t order_id{0};
+        uint32_t size{0};
+        bool buy{false};
+    };
+
+    struct SymbolState {
+        uint32_t symbol_id{0};
+        int64_t anchor{0};
+        int64_t mid{0};
+        std::vector<RestingOrder> live;
+    };
+
+    template <typename Message>
+    Message& emit(uint16_t type, uint32_t sequence) {
+        auto& msg = *reinterpret_cast<Message*>(buffer_.data());
+        msg = Message{};
+        msg.header.msg_type = type;
+        msg.header.msg_len = sizeof(Message);
+        msg.header.sequence_num = sequence;
+        return msg;
+    }
+
+    uint64_t next_order_id() {
+        const uint64_t order_id = next_order_id_;
+        next_order_id_ += std::max<uint32_t>(1, model_.partitions);
+        return order_id;
+    }
+
+    static double unit(uint64_t bits) {
+        return static_cast<double>(bits >> 11) * 0x1.0p-53;
+    }
+
+    static uint32_t lot(uint64_t bits) {
+        return static_cast<uint32_t>(1 + (bits >> 1 & 0xFF) % 5) * 100;
+    }
+
+    static int64_t depth(uint64_t bits) {
+        const uint64_t band = (bits >> 16 & 0xFFFF) | 0x10000;
+        return static_cast<int64_t>(__builtin_ctzll(band)) * 4 + static_cast<int64_t>(bits >> 40 & 3);
+    }
+
+    void build_alias_table(const std::vector<double>& weights) {
+        const size_t n = weights.size();
+        double total = 0.0;
+        for (double weight : weights) {
+            total += weight;
+        }
+
+        std::vector<double> scaled(n);
+        std::vector<uint32_t> small;
+        std::vector<uint32_t> large;
+        for (size_t idx = 0; idx < n; ++idx) {
+            scaled[idx] = weights[idx] * static_cast<double>(n) / total;
+            (scaled[idx] < 1.0 ? small : large).push_back(static_cast<uint32_t>(idx));
+        }
+
+        alias_.assign(n, AliasEntry{});
+        while (!small.empty() && !large.empty()) {
+            const uint32_t low = small.back();
+            const uint32_t high = large.back();
+            small.pop_back();
+            alias_[low] = AliasEntry{scaled[low], high};
+            scaled[high] -= 1.0 - scaled[low];
+            if (scaled[high] < 1.0) {
+                large.pop_back();
+                small.push_back(high);
+            }
+        }
+        for (uint32_t idx : large) {
+            alias_[idx] = AliasEntry{1.0, idx};
+        }
+        for (uint32_t idx : small) {
+            alias_[idx] = AliasEntry{1.0, idx};
+        }
+    }
+
+    uint32_t pick_symbol() {
+        const uint64_t bits = rng_();
+        const uint32_t column = static_cast<uint32_t>(((bits & 0xFFFFFFFF) * alias_.size()) >> 32);
+        const AliasEntry& entry = alias_[column];
+        return static_cast<double>(bits >> 32) * 0x1.0p-32 < entry.threshold ? column : entry.alias;
+    }
+
+    static double uptick_probability(const SymbolState& state) {
+        const double drift = static_cast<double>(state.mid - state.anchor) / kHalfSpread;
+        return std::clamp(0.5 - drift, 0.05, 0.95);
+    }
+
+    double cancel_probability(const SymbolState& state) const {
+        const double fill = static_cast<double>(state.live.size()) / (2.0 * std::max<uint32_t>(1, model_.target_depth));
+        return std::min(0.95, fill);
+    }
+
+    FeedModel model_;
+    std::vector<SymbolState> symbols_;
+    std::mt19937_64 rng_;
+    std::vector<AliasEntry> alias_;
+    alignas(8) std::array<char, 64> buffer_{};
+    double share_{0.0};
+    uint32_t sequence_{1};
+    uint64_t next_order_id_;
+};
+
+}
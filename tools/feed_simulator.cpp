@@ -1,10 +1,17 @@
 
+#include "feed_generator.h"
+#include "recovery_server.h"
 #include "../src/market_data.h"
 #include "../src/utils/timestamp.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
 #include <chrono>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <random>
 #include <stdexcept>
 #include <string>
@@ -19,6 +26,7 @@
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #endif
 
@@ -61,6 +69,20 @@ struct FeedConfig {
     uint32_t rate{1'000'000};
     uint32_t symbol_count{100};
     uint64_t duration_seconds{10};
+    uint32_t pack{1};
+    std::string line_b;
+    uint16_t line_b_port{0};
+    double drop_a{0.0};
+    double drop_b{0.0};
+    uint16_t recovery_port{0};
+    uint64_t linger_seconds{2};
+    uint32_t threads{1};
+    uint32_t batch{32};
+    double zipf{1.0};
+    uint32_t depth{100};
+    double burst_factor{1.0};
+    uint64_t burst_ms{0};
+    uint64_t burst_every_ms{1000};
 };
 
 FeedConfig parse_args(int argc, char** argv) {
@@ -77,8 +99,45 @@ FeedConfig parse_args(int argc, char** argv) {
             cfg.symbol_count = static_cast<uint32_t>(std::stoul(argv[++i]));
         } else if (arg == "--duration" && i + 1 < argc) {
             cfg.duration_seconds = static_cast<uint64_t>(std::stoull(argv[++i]));
+        } else if (arg == "--pack" && i + 1 < argc) {
+            cfg.pack = std::max<uint32_t>(1, static_cast<uint32_t>(std::stoul(argv[++i])));
+        } else if (arg == "--line-b" && i + 1 < argc) {
+            const std::string line = argv[++i];
+            const size_t colon = line.find(':');
+            cfg.line_b = line.substr(0, colon);
+            if (colon != std::string::npos) {
+                cfg.line_b_port = static_cast<uint16_t>(std::stoi(line.substr(colon + 1)));
+            }
+        } else if (arg == "--drop-a" && i + 1 < argc) {
+            cfg.drop_a = std::stod(argv[++i]) / 100.0;
+        } else if (arg == "--drop-b" && i + 1 < argc) {
+            cfg.drop_b = std::stod(argv[++i]) / 100.0;
+        } else if (arg == "--recovery-port" && i + 1 < argc) {
+            cfg.recovery_port = static_cast<uint16_t>(std::stoi(argv[++i]));
+        } else if (arg == "--linger" && i + 1 < argc) {
+            cfg.linger_seconds = static_cast<uint64_t>(std::stoull(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            cfg.threads = std::max<uint32_t>(1, static_cast<uint32_t>(std::stoul(argv[++i])));
+        } else if (arg == "--batch" && i + 1 < argc) {
+            cfg.batch = std::clamp<uint32_t>(static_cast<uint32_t>(std::stoul(argv[++i])), 1, 1024);
+        } else if (arg == "--zipf" && i + 1 < argc) {
+            cfg.zipf = std::max(0.0, std::stod(argv[++i]));
+        } else if (arg == "--depth" && i + 1 < argc) {
+            cfg.depth = std::max<uint32_t>(1, static_cast<uint32_t>(std::stoul(argv[++i])));
+        } else if (arg == "--burst" && i + 1 < argc) {
+            const std::string spec = argv[++i];
+            const size_t first = spec.find(':');
+            const size_t second = first == std::string::npos ? std::string::npos : spec.find(':', first + 1);
+            cfg.burst_factor = std::max(1.0, std::stod(spec.substr(0, first)));
+            if (first != std::string::npos) {
+                cfg.burst_ms = static_cast<uint64_t>(std::stoull(spec.substr(first + 1, second - first - 1)));
+            }
+            if (second != std::string::npos) {
+                cfg.burst_every_ms = std::max<uint64_t>(1, std::stoull(spec.substr(second + 1)));
+            }
         }
     }
+    cfg.threads = std::min(cfg.threads, std::max<uint32_t>(1, cfg.symbol_count));
     return cfg;
 }
 
@@ -96,148 +155,413 @@ socket_handle_t create_socket() {
     }
     int ttl = 1;
     setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, reinterpret_cast<char*>(&ttl), sizeof(ttl));
+    int sndbuf = 4 * 1024 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<char*>(&sndbuf), sizeof(sndbuf));
     return sock;
 }
 
-void send_message(socket_handle_t fd, const sockaddr_in& endpoint, const char* buffer, size_t length) {
-    sendto(fd, buffer, static_cast<int>(length), 0,
-           reinterpret_cast<const sockaddr*>(&endpoint), sizeof(endpoint));
+void close_socket(socket_handle_t sock) {
+#ifdef _WIN32
+    closesocket(sock);
+#else
+    close(sock);
+#endif
 }
 
+struct FeedLine {
+    sockaddr_in endpoint{};
+    double drop{0.0};
+    uint64_t sent{0};
+    uint64_t dropped{0};
+};
+
+FeedLine make_line(const std::string& multicast, uint16_t port, double drop) {
+    FeedLine line;
+    line.endpoint.sin_family = AF_INET;
+    line.endpoint.sin_port = htons(port);
+    inet_pton(AF_INET, multicast.c_str(), &line.endpoint.sin_addr);
+    line.drop = drop;
+    return line;
 }
 
-int main(int argc, char** argv) {
+std::vector<FeedLine> make_lines(const FeedConfig& cfg) {
+    std::vector<FeedLine> lines;
+    lines.push_back(make_line(cfg.multicast, cfg.port, cfg.drop_a));
+    if (!cfg.line_b.empty()) {
+        lines.push_back(make_line(cfg.line_b, cfg.line_b_port != 0 ? cfg.line_b_port : cfg.port, cfg.drop_b));
+    }
+    return lines;
+}
 
-    const auto cfg = parse_args(argc, argv);
-    std::cout << "Feed simulator -> " << cfg.multicast << ":" << cfg.port << " @ " << cfg.rate << " msg/sec\n";
+class RateSchedule {
+public:
 
-    socket_handle_t sock = create_socket();
+    RateSchedule(double rate, double burst_factor, uint64_t burst_ns, uint64_t period_ns)
+        : rate_(rate), burst_factor_(burst_factor), burst_ns_(std::min(burst_ns, period_ns)), period_ns_(period_ns) {}
 
-    sockaddr_in endpoint{};
-    endpoint.sin_family = AF_INET;
-    endpoint.sin_port = htons(cfg.port);
-    inet_pton(AF_INET, cfg.multicast.c_str(), &endpoint.sin_addr);
+    bool unlimited() const {
+        return rate_ <= 0.0;
+    }
 
-    std::mt19937_64 rng(42);
+    double rate_at(uint64_t elapsed_ns) const {
+        return in_burst(elapsed_ns) ? rate_ * burst_factor_ : rate_;
+    }
 
-    std::uniform_int_distribution<int64_t> price_delta(-500, 500);
-    std::uniform_int_distribution<uint32_t> size_dist(100, 500);
-    std::uniform_int_distribution<int> type_dist(1, 4);
-    std::uniform_int_distribution<int> side_dist(0, 1);
+    uint64_t allowance(uint64_t elapsed_ns) const {
+        double active_ns = static_cast<double>(elapsed_ns);
+        if (burst_ns_ != 0) {
+            const uint64_t burst_elapsed = elapsed_ns / period_ns_ * burst_ns_ + std::min(elapsed_ns % period_ns_, burst_ns_);
+            active_ns += (burst_factor_ - 1.0) * static_cast<double>(burst_elapsed);
+        }
+        return static_cast<uint64_t>(active_ns * rate_ / 1e9);
+    }
 
-    std::vector<uint32_t> symbols(cfg.symbol_count);
-    for (uint32_t i = 0; i < cfg.symbol_count; ++i) {
-        symbols[i] = 1000 + i;
+private:
+
+    bool in_burst(uint64_t elapsed_ns) const {
+        return burst_ns_ != 0 && elapsed_ns % period_ns_ < burst_ns_;
     }
 
-    uint32_t sequence = 1;
-    uint64_t order_id = 1;
+    double rate_;
+    double burst_factor_;
+    uint64_t burst_ns_;
+    uint64_t period_ns_;
+};
 
-    auto next_send = std::chrono::steady_clock::now();
-    const auto interval = std::chrono::nanoseconds(1'000'000'000LL / cfg.rate);
-    const auto stop_time = std::chrono::steady_clock::now() + std::chrono::seconds(cfg.duration_seconds);
+class SequenceSpace {
+public:
 
-    while (std::chrono::steady_clock::now() < stop_time) {
+    uint32_t claim(uint32_t count) {
+        return next_.fetch_add(count, std::memory_order_relaxed);
+    }
 
-        const uint32_t symbol = symbols[sequence % symbols.size()];
+private:
 
-        const int msg_type = type_dist(rng);
+    alignas(64) std::atomic<uint32_t> next_{1};
+};
 
-        switch (msg_type) {
-            case market::MSG_QUOTE: {
+class PacketBuilder {
+public:
 
-                market::Quote quote{};
+    static constexpr size_t kMaxPacket = 1400;
 
-                quote.header.msg_type = market::MSG_QUOTE;
-                quote.header.msg_len = sizeof(quote);
-                quote.header.sequence_num = sequence++;
-                quote.header.timestamp_ns = market::now_ns();
+    PacketBuilder(socket_handle_t fd, std::vector<FeedLine>& lines, SequenceSpace& sequences,
+                  feed::RecoveryServer* recovery, uint32_t partition, uint32_t max_messages, uint32_t batch,
+                  uint64_t drop_seed)
+        : fd_(fd), lines_(lines), sequences_(sequences), recovery_(recovery), partition_(partition),
+          max_messages_(max_messages), packets_(batch), sizes_(batch), selected_(batch), drop_rng_(drop_seed) {
+#ifdef __linux__
+        iov_.resize(batch);
+        msgs_.resize(batch);
+#endif
+    }
 
-                quote.symbol_id = symbol;
-                quote.bid_price = 1'500'000 + price_delta(rng);
-                quote.ask_price = quote.bid_price + 25;
-                quote.bid_size = size_dist(rng);
-                quote.ask_size = size_dist(rng);
+    void append(const market::MessageHeader* message) {
+        if (size_ + message->msg_len > kMaxPacket) {
+            seal();
+        }
 
-                send_message(sock, endpoint, reinterpret_cast<const char*>(&quote), sizeof(quote));
-                break;
-            }
+        std::memcpy(packets_[filled_].data() + size_, message, message->msg_len);
+        size_ += message->msg_len;
+        if (++pending_ >= max_messages_) {
+            seal();
+        }
+    }
 
-            case market::MSG_ORDER_ADD: {
+    void flush() {
+        seal();
+        send_batch();
+    }
 
-                market::OrderAdd add{};
+    uint64_t messages() const {
+        return messages_;
+    }
 
-                add.header.msg_type = market::MSG_ORDER_ADD;
-                add.header.msg_len = sizeof(add);
-                add.header.sequence_num = sequence++;
-                add.header.timestamp_ns = market::now_ns();
+    uint64_t packets() const {
+        return packets_sent_;
+    }
 
-                add.order_id = order_id++;
-                add.symbol_id = symbol;
-                add.price = 1'500'000 + price_delta(rng);
-                add.size = size_dist(rng);
-                add.side = side_dist(rng) ? 'B' : 'S';
+    uint64_t send_calls() const {
+        return send_calls_;
+    }
 
-                send_message(sock, endpoint, reinterpret_cast<const char*>(&add), sizeof(add));
-                break;
-            }
+    uint64_t send_errors() const {
+        return send_errors_;
+    }
 
-            case market::MSG_ORDER_CANCEL: {
+private:
 
-                market::OrderCancel cancel{};
+    void seal() {
+        if (pending_ == 0) {
+            return;
+        }
 
-                cancel.header.msg_type = market::MSG_ORDER_CANCEL;
-                cancel.header.msg_len = sizeof(cancel);
-                cancel.header.sequence_num = sequence++;
-                cancel.header.timestamp_ns = market::now_ns();
+        sizes_[filled_] = size_;
+        batch_messages_ += pending_;
+        messages_ += pending_;
+        size_ = 0;
+        pending_ = 0;
+        if (++filled_ == packets_.size()) {
+            send_batch();
+        }
+    }
 
-                cancel.order_id = order_id > 0 ? order_id - 1 : 1;
-                cancel.symbol_id = symbol;
+    void send_batch() {
+        if (filled_ == 0) {
+            return;
+        }
 
-                send_message(sock, endpoint, reinterpret_cast<const char*>(&cancel), sizeof(cancel));
-                break;
+        uint32_t sequence = sequences_.claim(batch_messages_);
+        const uint64_t now = market::now_ns();
+        for (size_t idx = 0; idx < filled_; ++idx) {
+            for (size_t offset = 0; offset < sizes_[idx];) {
+                auto* header = reinterpret_cast<market::MessageHeader*>(packets_[idx].data() + offset);
+                header->sequence_num = sequence++;
+                header->timestamp_ns = now;
+                offset += header->msg_len;
+            }
+            if (recovery_ != nullptr) {
+                recovery_->apply(partition_, packets_[idx].data(), sizes_[idx]);
+            }
+        }
+        batch_messages_ = 0;
+
+        for (FeedLine& line : lines_) {
+            size_t count = 0;
+            for (size_t idx = 0; idx < filled_; ++idx) {
+                if (line.drop > 0.0 && drop_dist_(drop_rng_) < line.drop) {
+                    ++line.dropped;
+                    continue;
+                }
+                selected_[count++] = idx;
             }
+            line.sent += send_packets(line.endpoint, count);
+        }
+        packets_sent_ += filled_;
+        filled_ = 0;
+    }
 
-            case market::MSG_TRADE: {
+    size_t send_packets(const sockaddr_in& endpoint, size_t count) {
+#ifdef __linux__
+        for (size_t idx = 0; idx < count; ++idx) {
+            iov_[idx].iov_base = packets_[selected_[idx]].data();
+            iov_[idx].iov_len = sizes_[selected_[idx]];
+            msgs_[idx] = mmsghdr{};
+            msgs_[idx].msg_hdr.msg_name = const_cast<sockaddr_in*>(&endpoint);
+            msgs_[idx].msg_hdr.msg_namelen = sizeof(endpoint);
+            msgs_[idx].msg_hdr.msg_iov = &iov_[idx];
+            msgs_[idx].msg_hdr.msg_iovlen = 1;
+        }
 
-                market::Trade trade{};
+        size_t done = 0;
+        while (done < count) {
+            const int sent = sendmmsg(fd_, msgs_.data() + done, static_cast<unsigned int>(count - done), 0);
+            ++send_calls_;
+            if (sent > 0) {
+                done += static_cast<size_t>(sent);
+            } else if (errno != EINTR) {
+                ++send_errors_;
+                break;
+            }
+        }
+        return done;
+#else
+        size_t done = 0;
+        for (size_t idx = 0; idx < count; ++idx) {
+            const size_t packet = selected_[idx];
+            if (sendto(fd_, packets_[packet].data(), static_cast<int>(sizes_[packet]), 0,
+                       reinterpret_cast<const sockaddr*>(&endpoint), sizeof(endpoint)) >= 0) {
+                ++done;
+            } else {
+                ++send_errors_;
+            }
+            ++send_calls_;
+        }
+        return done;
+#endif
+    }
 
-                trade.header.msg_type = market::MSG_TRADE;
-                trade.header.msg_len = sizeof(trade);
-                trade.header.sequence_num = sequence++;
-                trade.header.timestamp_ns = market::now_ns();
+    socket_handle_t fd_;
+    std::vector<FeedLine>& lines_;
+    SequenceSpace& sequences_;
+    feed::RecoveryServer* recovery_;
+    uint32_t partition_;
+    uint32_t max_messages_;
+    std::vector<std::array<char, kMaxPacket>> packets_;
+    std::vector<size_t> sizes_;
+    std::vector<size_t> selected_;
+#ifdef __linux__
+    std::vector<iovec> iov_;
+    std::vector<mmsghdr> msgs_;
+#endif
+    std::mt19937_64 drop_rng_;
+    std::uniform_real_distribution<double> drop_dist_{0.0, 1.0};
+    size_t filled_{0};
+    size_t size_{0};
+    uint32_t pending_{0};
+    uint32_t batch_messages_{0};
+    uint64_t messages_{0};
+    uint64_t packets_sent_{0};
+    uint64_t send_calls_{0};
+    uint64_t send_errors_{0};
+};
 
-                trade.symbol_id = symbol;
-                trade.price = 1'500'000 + price_delta(rng);
-                trade.size = size_dist(rng);
-                trade.side = side_dist(rng) ? 'B' : 'S';
+struct SenderResult {
+    uint64_t messages{0};
+    uint64_t packets{0};
+    uint64_t send_calls{0};
+    uint64_t send_errors{0};
+    size_t live_orders{0};
+    std::vector<FeedLine> lines;
+};
 
-                send_message(sock, endpoint, reinterpret_cast<const char*>(&trade), sizeof(trade));
-                break;
-            }
+SenderResult run_sender(const FeedConfig& cfg, uint32_t index, SequenceSpace& sequences, feed::RecoveryServer* recovery,
+                        uint64_t start_ns) {
 
-            default: {
+    constexpr uint64_t kChunk = 256;
+    constexpr uint64_t kMinSleepNs = 100'000;
+    constexpr uint64_t kMaxSleepNs = 1'000'000;
 
-                break;
+    SenderResult result;
+    result.lines = make_lines(cfg);
+    socket_handle_t sock = create_socket();
+    PacketBuilder packet(sock, result.lines, sequences, recovery, index, cfg.pack, cfg.batch, 7 + index);
+
+    feed::FeedModel model;
+    model.symbol_count = cfg.symbol_count;
+    model.zipf_exponent = cfg.zipf;
+    model.target_depth = cfg.depth;
+    model.partition = index;
+    model.partitions = cfg.threads;
+    feed::FeedGenerator generator(model);
+
+    const RateSchedule schedule(static_cast<double>(cfg.rate) * generator.share(), cfg.burst_factor,
+                                cfg.burst_ms * 1'000'000, cfg.burst_every_ms * 1'000'000);
+    const uint64_t stop_ns = start_ns + cfg.duration_seconds * 1'000'000'000ULL;
+    uint64_t emitted = 0;
+
+    while (true) {
+        const uint64_t now = market::now_ns();
+        if (now >= stop_ns) {
+            break;
+        }
+
+        uint64_t chunk = kChunk;
+        if (!schedule.unlimited()) {
+            const uint64_t elapsed = now > start_ns ? now - start_ns : 0;
+            const uint64_t allowed = schedule.allowance(elapsed);
+            if (emitted >= allowed) {
+                packet.flush();
+                const double wait_ns = static_cast<double>(emitted - allowed + 1) * 1e9 / schedule.rate_at(elapsed);
+                std::this_thread::sleep_for(std::chrono::nanoseconds(
+                    std::clamp(static_cast<uint64_t>(wait_ns), kMinSleepNs, kMaxSleepNs)));
+                continue;
             }
+            chunk = std::min(chunk, allowed - emitted);
         }
 
-        std::this_thread::sleep_until(next_send);
-        next_send += interval;
+        for (uint64_t idx = 0; idx < chunk; ++idx) {
+            packet.append(generator.next(0));
+        }
+        emitted += chunk;
     }
+    packet.flush();
+    close_socket(sock);
+
+    result.messages = packet.messages();
+    result.packets = packet.packets();
+    result.send_calls = packet.send_calls();
+    result.send_errors = packet.send_errors();
+    result.live_orders = generator.live_orders();
+    return result;
+}
+}
 
-    if (sock != -1
-#ifdef _WIN32
-        && sock != INVALID_SOCKET
-#endif
-    ) {
-#ifdef _WIN32
-        closesocket(sock);
-#else
-        close(sock);
-#endif
+int main(int argc, char** argv) {
+
+    const auto cfg = parse_args(argc, argv);
+    std::cout << "Feed simulator -> " << cfg.multicast << ":" << cfg.port << " @ ";
+    if (cfg.rate == 0) {
+        std::cout << "max rate";
+    } else {
+        std::cout << cfg.rate << " msg/sec";
+    }
+    if (cfg.pack > 1) {
+        std::cout << ", up to " << cfg.pack << " msg/packet";
+    }
+    std::cout << ", " << cfg.threads << " sender thread" << (cfg.threads > 1 ? "s" : "")
+              << ", batch " << cfg.batch << ", zipf " << cfg.zipf << "\n";
+    if (cfg.burst_ms != 0 && cfg.burst_factor > 1.0) {
+        std::cout << "Bursts: " << cfg.burst_factor << "x for " << cfg.burst_ms << "ms every "
+                  << cfg.burst_every_ms << "ms\n";
+    }
+    if (!cfg.line_b.empty()) {
+        std::cout << "Line B -> " << cfg.line_b << ":" << (cfg.line_b_port != 0 ? cfg.line_b_port : cfg.port)
+                  << " (drop A " << cfg.drop_a * 100.0 << "%, drop B " << cfg.drop_b * 100.0 << "%)\n";
     }
 
-    std::cout << "Feed simulator finished after " << cfg.duration_seconds << "s\n";
+    std::unique_ptr<feed::RecoveryServer> recovery;
+    if (cfg.recovery_port != 0) {
+        recovery = std::make_unique<feed::RecoveryServer>(cfg.symbol_count, cfg.recovery_port, cfg.threads);
+        std::cout << "Recovery snapshots on 127.0.0.1:" << recovery->port() << "\n";
+    }
+
+    SequenceSpace sequences;
+    std::vector<SenderResult> results(cfg.threads);
+    std::vector<std::thread> senders;
+    const uint64_t start_ns = market::now_ns();
+    for (uint32_t index = 0; index < cfg.threads; ++index) {
+        senders.emplace_back([&, index]() {
+            results[index] = run_sender(cfg, index, sequences, recovery.get(), start_ns);
+        });
+    }
+    for (std::thread& sender : senders) {
+        sender.join();
+    }
+    const double elapsed = static_cast<double>(market::now_ns() - start_ns) / 1e9;
+
+    if (recovery && cfg.linger_seconds > 0) {
+        std::this_thread::sleep_for(std::chrono::seconds(cfg.linger_seconds));
+    }
+
+    SenderResult total;
+    total.lines = make_lines(cfg);
+    for (const SenderResult& result : results) {
+        total.messages += result.messages;
+        total.packets += result.packets;
+        total.send_calls += result.send_calls;
+        total.send_errors += result.send_errors;
+        total.live_orders += result.live_orders;
+        for (size_t idx = 0; idx < total.lines.size(); ++idx) {
+            total.lines[idx].sent += result.lines[idx].sent;
+            total.lines[idx].dropped += result.lines[idx].dropped;
+        }
+    }
+
+    std::cout << "Feed simulator finished after " << elapsed << "s: " << total.messages
+              << " messages in " << total.packets << " packets ("
+              << (total.packets == 0 ? 0.0 : static_cast<double>(total.messages) / total.packets)
+              << " msg/packet)\n";
+    std::cout << "  Achieved " << static_cast<uint64_t>(total.messages / elapsed) << " msg/sec";
+    if (cfg.rate != 0) {
+        std::cout << " (target " << cfg.rate << ")";
+    }
+    std::cout << ", " << static_cast<uint64_t>(total.packets / elapsed) << " packets/sec, "
+              << (total.send_calls == 0 ? 0.0 : static_cast<double>(total.packets * total.lines.size()) / total.send_calls)
+              << " packets per send call";
+    if (total.send_errors != 0) {
+        std::cout << ", " << total.send_errors << " send errors";
+    }
+    std::cout << "\n";
+    std::cout << "  Resting orders at end: " << total.live_orders << "\n";
+    for (size_t idx = 0; idx < total.lines.size(); ++idx) {
+        if (total.lines.size() > 1 || total.lines[idx].dropped != 0) {
+            std::cout << "  Line " << static_cast<char>('A' + idx) << ": " << total.lines[idx].sent << " packets sent, "
+                      << total.lines[idx].dropped << " dropped\n";
+        }
+    }
+    if (recovery) {
+        std::cout << "  Recovery: " << recovery->snapshots_served() << " snapshots served\n";
+    }
     return 0;
 }
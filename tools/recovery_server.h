@@ -0,0 +1,283 @@
+#pragma once
+
+#include "../src/book_manager.h"
+#include "../src/market_data.h"
+#include "../src/recovery.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace feed {
+
+class RecoveryServer {
+public:
+
+    using Book = market::OrderBook<market::MapLevels, market::StdOrderIndex>;
+
+    RecoveryServer(uint32_t symbol_count, uint16_t port, uint32_t partitions = 1)
+        : books_(symbol_count, 1000 + symbol_count) {
+
+        for (uint32_t partition = 0; partition < partitions; ++partition) {
+            partitions_.push_back(std::make_unique<Partition>());
+        }
+
+#ifdef _WIN32
+        WSADATA data{};
+        WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+        listener_ = socket(AF_INET, SOCK_STREAM, 0);
+        const int reuse = 1;
+        setsockopt(listener_, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listener_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener_, 4) != 0) {
+            close_socket(listener_);
+            throw std::runtime_error("Failed to listen for recovery requests");
+        }
+
+        socklen_t len = sizeof(addr);
+        getsockname(listener_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+        thread_ = std::thread([this]() { serve(); });
+    }
+
+    ~RecoveryServer() {
+        running_.store(false, std::memory_order_release);
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        close_socket(listener_);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    RecoveryServer(const RecoveryServer&) = delete;
+    RecoveryServer& operator=(const RecoveryServer&) = delete;
+
+    void apply(uint32_t partition, const char* data, size_t len) {
+        Partition& part = *partitions_[partition];
+        std::lock_guard<std::mutex> lock(part.mutex);
+        part.pending.insert(part.pending.end(), data, data + len);
+    }
+
+    void apply(const market::MessageHeader* header) {
+        apply(0, reinterpret_cast<const char*>(header), header->msg_len);
+    }
+
+    uint16_t port() const {
+        return port_;
+    }
+
+    uint64_t snapshots_served() const {
+        return served_.load(std::memory_order_relaxed);
+    }
+
+private:
+
+#ifdef _WIN32
+    using handle_t = SOCKET;
+#else
+    using handle_t = int;
+#endif
+
+    static void close_socket(handle_t fd) {
+#ifdef _WIN32
+        closesocket(fd);
+#else
+        close(fd);
+#endif
+    }
+
+    template <typename Message>
+    static void append(std::vector<char>& out, const Message& msg) {
+        const char* bytes = reinterpret_cast<const char*>(&msg);
+        out.insert(out.end(), bytes, bytes + sizeof(msg));
+    }
+
+    template <typename Message>
+    static Message make(uint16_t type, uint32_t sequence) {
+        Message msg{};
+        msg.header.msg_type = type;
+        msg.header.msg_len = sizeof(msg);
+        msg.header.sequence_num = sequence;
+        return msg;
+    }
+
+    struct Partition {
+        std::mutex mutex;
+        std::vector<char> pending;
+        std::vector<char> backlog;
+        size_t applied{0};
+    };
+
+    void advance() {
+        for (const auto& part : partitions_) {
+            std::lock_guard<std::mutex> lock(part->mutex);
+            part->backlog.insert(part->backlog.end(), part->pending.begin(), part->pending.end());
+            part->pending.clear();
+        }
+
+        uint32_t next = sequence_ + 1;
+        for (bool progressed = true; progressed;) {
+            progressed = false;
+            for (const auto& part : partitions_) {
+                while (part->applied < part->backlog.size()) {
+                    const auto* header =
+                        reinterpret_cast<const market::MessageHeader*>(part->backlog.data() + part->applied);
+                    if (header->sequence_num != next) {
+                        break;
+                    }
+                    books_.on_message(header);
+                    part->applied += header->msg_len;
+                    ++next;
+                    progressed = true;
+                }
+            }
+        }
+
+        for (const auto& part : partitions_) {
+            part->backlog.erase(part->backlog.begin(), part->backlog.begin() + static_cast<std::ptrdiff_t>(part->applied));
+            part->applied = 0;
+        }
+        sequence_ = next - 1;
+    }
+
+    uint32_t snapshot(std::vector<char>& out, uint32_t& count) {
+        advance();
+
+        count = 0;
+        for (uint32_t slot = 0; slot < books_.active_symbols(); ++slot) {
+            const uint32_t symbol = books_.symbol_at(slot);
+            const Book& book = *books_.find(symbol);
+
+            auto reset = make<market::BookReset>(market::MSG_BOOK_RESET, sequence_);
+            reset.symbol_id = symbol;
+            append(out, reset);
+            ++count;
+
+            std::vector<std::pair<char, int64_t>> order_prices;
+            book.orders().for_each([&](const market::Order& order) {
+                auto add = make<market::OrderAdd>(market::MSG_ORDER_ADD, sequence_);
+                add.order_id = order.order_id;
+                add.symbol_id = symbol;
+                add.price = order.price;
+                add.size = order.size;
+                add.side = order.side;
+                append(out, add);
+                order_prices.emplace_back(order.side, order.price);
+                ++count;
+            });
+
+            auto set_level = [&](char side, int64_t price, uint32_t size) {
+                auto level = make<market::LevelSet>(market::MSG_LEVEL_SET, sequence_);
+                level.symbol_id = symbol;
+                level.price = price;
+                level.size = size;
+                level.side = side;
+                append(out, level);
+                ++count;
+            };
+
+            for (const auto& [side, price] : order_prices) {
+                set_level(side, price, 0);
+            }
+            for (const char side : {'B', 'S'}) {
+                book.levels().for_each_level(side, std::numeric_limits<int>::max(),
+                                             [&](int64_t price, uint32_t size) { set_level(side, price, size); });
+            }
+        }
+        return sequence_;
+    }
+
+    void serve() {
+        while (running_.load(std::memory_order_acquire)) {
+            advance();
+#ifdef _WIN32
+            WSAPOLLFD ready{};
+            ready.fd = listener_;
+            ready.events = POLLIN;
+            if (WSAPoll(&ready, 1, 100) <= 0) {
+                continue;
+            }
+#else
+            pollfd ready{};
+            ready.fd = listener_;
+            ready.events = POLLIN;
+            if (poll(&ready, 1, 100) <= 0) {
+                continue;
+            }
+#endif
+            const handle_t client = accept(listener_, nullptr, nullptr);
+            if (client == static_cast<handle_t>(-1)) {
+                continue;
+            }
+
+            market::SnapshotRequest request{};
+            if (recv(client, reinterpret_cast<char*>(&request), sizeof(request), MSG_WAITALL) ==
+                    static_cast<int>(sizeof(request)) &&
+                request.magic == market::kSnapshotMagic) {
+
+                std::vector<char> body;
+                uint32_t count = 0;
+                const uint32_t sequence = snapshot(body, count);
+                const market::SnapshotHeader header{market::kSnapshotMagic, sequence, count,
+                                                    static_cast<uint32_t>(body.size())};
+                send_all(client, reinterpret_cast<const char*>(&header), sizeof(header));
+                send_all(client, body.data(), body.size());
+                served_.fetch_add(1, std::memory_order_relaxed);
+            }
+            close_socket(client);
+        }
+    }
+
+    static void send_all(handle_t fd, const char* data, size_t len) {
+        size_t done = 0;
+        while (done < len) {
+#ifdef MSG_NOSIGNAL
+            const auto sent = send(fd, data + done, static_cast<int>(len - done), MSG_NOSIGNAL);
+#else
+            const auto sent = send(fd, data + done, static_cast<int>(len - done), 0);
+#endif
+            if (sent <= 0) {
+                return;
+            }
+            done += static_cast<size_t>(sent);
+        }
+    }
+
+    market::BookManager<Book> books_;
+    std::vector<std::unique_ptr<Partition>> partitions_;
+    uint32_t sequence_{0};
+    handle_t listener_;
+    uint16_t port_{0};
+    std::thread thread_;
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> served_{0};
+};
+
+}
@@ -0,0 +1,131 @@
+#include "../src/shm_book.h"
+#include "../src/utils/timestamp.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct ReaderConfig {
+    std::string name{"/market_books"};
+    std::vector<uint32_t> symbols;
+    uint32_t depth{0};
+    uint64_t interval_ms{1000};
+    uint64_t count{0};
+};
+
+ReaderConfig parse_args(int argc, char** argv) {
+    ReaderConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--shm" && i + 1 < argc) {
+            cfg.name = argv[++i];
+        } else if (arg == "--depth" && i + 1 < argc) {
+            cfg.depth = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--interval-ms" && i + 1 < argc) {
+            cfg.interval_ms = static_cast<uint64_t>(std::stoull(argv[++i]));
+        } else if (arg == "--count" && i + 1 < argc) {
+            cfg.count = static_cast<uint64_t>(std::stoull(argv[++i]));
+        } else if (arg == "--symbols" && i + 1 < argc) {
+
+            std::istringstream iss(argv[++i]);
+            std::string token;
+            while (std::getline(iss, token, ',')) {
+                if (!token.empty()) {
+                    cfg.symbols.push_back(static_cast<uint32_t>(std::stoul(token)));
+                }
+            }
+        }
+    }
+    return cfg;
+}
+
+std::string format_price(int64_t price) {
+    if (price == 0) {
+        return "n/a";
+    }
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(4) << static_cast<double>(price) / 10000.0;
+    return oss.str();
+}
+
+void print_book(const market::ShmBook& book, uint32_t depth) {
+    std::cout << "[BOOK " << book.symbol_id << "] seq " << book.sequence_num << ", ts " << book.timestamp_ns
+              << (book.stale != 0 ? " (stale, recovering)" : "") << "\n";
+    const uint32_t rows = std::min(std::max(book.bid_levels, book.ask_levels), depth);
+    for (uint32_t level = 0; level < rows; ++level) {
+        std::cout << "  ";
+        if (level < book.bid_levels) {
+            std::cout << std::setw(10) << book.bids[level].size << " @ " << std::setw(12)
+                      << format_price(book.bids[level].price);
+        } else {
+            std::cout << std::setw(28) << "";
+        }
+        std::cout << "  |  ";
+        if (level < book.ask_levels) {
+            std::cout << std::setw(12) << format_price(book.asks[level].price) << " x " << book.asks[level].size;
+        }
+        std::cout << "\n";
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+
+    const ReaderConfig cfg = parse_args(argc, argv);
+    const market::ShmBookReader reader(cfg.name);
+    const market::ShmBookHeader& header = reader.header();
+    const uint32_t depth = cfg.depth == 0 || cfg.depth > header.depth ? header.depth : cfg.depth;
+
+    std::cout << "Reading " << cfg.name << ": " << header.symbol_count << " symbols, top " << header.depth
+              << " levels, writer pid " << header.writer_pid << "\n";
+
+    std::vector<uint32_t> seen(header.symbol_count, 0);
+    market::ShmBook book;
+    for (uint64_t round = 0; cfg.count == 0 || round < cfg.count; ++round) {
+
+        uint32_t printed = 0;
+        auto show = [&](uint32_t symbol) {
+            const uint32_t version = reader.version(symbol);
+            if (version == 0 || version == seen[symbol] || !reader.read(symbol, book)) {
+                return;
+            }
+            seen[symbol] = version;
+            print_book(book, depth);
+            ++printed;
+        };
+
+        if (cfg.symbols.empty()) {
+            for (uint32_t symbol = 0; symbol < header.symbol_count; ++symbol) {
+                show(symbol);
+            }
+        } else {
+            for (const uint32_t symbol : cfg.symbols) {
+                if (symbol < header.symbol_count) {
+                    show(symbol);
+                }
+            }
+        }
+
+        const uint64_t heartbeat = reader.heartbeat_ns();
+        const uint64_t now = market::realtime_ns();
+        std::cout << "-- " << printed << " updated, writer heartbeat "
+                  << (now > heartbeat ? (now - heartbeat) / 1'000'000 : 0) << "ms ago"
+                  << (reader.writer_closed() ? " (writer closed)" : "") << "\n";
+        if (reader.writer_closed()) {
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(cfg.interval_ms));
+    }
+    return 0;
+}